@@ -21,6 +21,8 @@ endmacro()
 macro(codys_setup_options)
   option(codys_ENABLE_HARDENING "Enable hardening" ON)
   option(codys_ENABLE_COVERAGE "Enable coverage reporting" ON)
+  option(codys_BUILD_BENCHMARKS "Build the benchmarks" OFF)
+  option(codys_FMA_CONTRACTION "Evaluate a * b + c in systems as fused multiply-adds" OFF)
   cmake_dependent_option(
     codys_ENABLE_GLOBAL_HARDENING
     "Attempt to push hardening options to built dependencies"
@@ -0,0 +1,293 @@
+#include <units/isq/si/acceleration.h>
+#include <units/isq/si/angular_acceleration.h>
+#include <units/isq/si/angular_velocity.h>
+#include <units/isq/si/length.h>
+#include <units/isq/si/speed.h>
+#include <units/generic/angle.h>
+#include <units/generic/dimensionless.h>
+
+#include <codys/Derivative.hpp>
+#include <codys/Integrator.hpp>
+#include <codys/Operators.hpp>
+#include <codys/ParallelEvaluation.hpp>
+#include <codys/Parareal.hpp>
+#include <codys/Quantity.hpp>
+#include <codys/RuntimeSystem.hpp>
+#include <codys/Schedule.hpp>
+#include <codys/StateSpaceSystem.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <sstream>
+#include <tuple>
+#include <utility>
+
+using namespace units::isq::si;
+using namespace units;
+
+namespace
+{
+
+using PositionX0 = codys::Quantity<class PositionX0_, length<metre>, "x_0">;
+using PositionX1 = codys::Quantity<class PositionX1_, length<metre>, "x_1">;
+using Velocity = codys::Quantity<class Velocity_, speed<metre_per_second>, "v">;
+using Yaw = codys::Quantity<class Yaw_, angle<radian, double>, "\\Phi">;
+using Rotation = codys::Quantity<class Rotation_, angular_velocity<radian_per_second>, "\\omega">;
+using PropellerAngle = codys::Quantity<class PropellerAngle_, angle<radian, double>, "\\Psi">;
+using EOT = codys::Quantity<class EOT_, dimensionless<one>, "EOT">;
+
+using p1 = codys::ScalarValue<std::ratio<1, 2>, acceleration<metre_per_second_sq>>;
+using p2 = codys::ScalarValue<std::ratio<1, 3>, angular_acceleration<radian_per_second_sq>>;
+using hundret = codys::ScalarValue<std::ratio<100>, dimensionless<one>>;
+
+struct DenebMotion
+{
+    constexpr static auto make_dot()
+    {
+        constexpr auto dot_pos_x0 = codys::dot<PositionX0>(Velocity{} * codys::cos(Yaw{}));
+        constexpr auto dot_pos_x1 = codys::dot<PositionX1>(Velocity{} * codys::sin(Yaw{}));
+        constexpr auto dot_velocity = codys::dot<Velocity>(p1{} * codys::cos(PropellerAngle{}) * (EOT{} / hundret{}));
+        constexpr auto dot_yaw = codys::dot<Yaw>(Rotation{});
+        constexpr auto dot_rotation = codys::dot<Rotation>(p2{} * codys::sin(PropellerAngle{}) * (EOT{} / hundret{}));
+
+        return std::make_tuple(dot_pos_x0, dot_pos_x1, dot_yaw, dot_velocity, dot_rotation);
+    }
+};
+
+// Eight weighted accelerations added up the way combine folds them,
+// w0 * a0 + (w1 * a1 + (... + w7 * a7)).
+template <std::size_t i>
+struct MixTag;
+
+template <std::size_t i>
+using Mix = codys::Quantity<MixTag<i>, acceleration<metre_per_second_sq>>;
+
+template <std::size_t i>
+using Weight = codys::ScalarValue<std::ratio<static_cast<std::intmax_t>(i) + 1, 8>, dimensionless<one>>;
+
+template <typename... Terms>
+struct chain;
+
+template <typename Term>
+struct chain<Term>
+{
+    using type = Term;
+};
+
+template <typename Term, typename... Rest>
+struct chain<Term, Rest...>
+{
+    using type = codys::Add<Term, typename chain<Rest...>::type>;
+};
+
+template <typename Indices>
+struct WeightedSum;
+
+template <std::size_t... i>
+struct WeightedSum<std::index_sequence<i...>>
+{
+    using Inputs = std::tuple<Mix<i>...>;
+    using Chain = typename chain<codys::Multiply<Weight<i>, Mix<i>>...>::type;
+};
+
+using Mixing = WeightedSum<std::make_index_sequence<8>>;
+
+constexpr auto denebConfig = R"(
+state x_0 m
+state x_1 m
+state Phi rad
+state v m/s
+state omega rad/s
+control Psi rad
+control EOT 1
+dot x_0 = v * cos(Phi)
+dot x_1 = v * sin(Phi)
+dot Phi = omega
+dot v = 0.5[m/s^2] * cos(Psi) * (EOT / 100)
+dot omega = 0.3333333333333333[rad/s^2] * sin(Psi) * (EOT / 100)
+)";
+
+constexpr std::size_t iterations = 2'000'000;
+
+// Every iteration perturbs the angles and EOT so that no part of the evaluation can be hoisted.
+template <typename Func>
+double nanoseconds_per_call(std::size_t callsPerIteration, Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        func(i);
+    }
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    return elapsed.count() / static_cast<double>(iterations * callsPerIteration);
+}
+
+template <typename Func>
+double seconds(Func&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <std::size_t N>
+void perturb(std::array<double, N>& in, std::size_t lanes, std::size_t iteration)
+{
+    const auto value = static_cast<double>(iteration & 1023U);
+    in[2 * lanes] = 1e-3 * value;
+    in[5 * lanes] = 2e-3 * value;
+    in[6 * lanes] = value;
+}
+
+template <typename Expression>
+double evaluate_mixing(const std::array<double, 8>& in)
+{
+    return Expression::template evaluate<Mixing::Inputs>(std::span<const double, 8>(in));
+}
+
+// every input depends on the previous result, which exposes the depth of the expression
+template <typename Expression>
+double mixing_latency(double& checksum)
+{
+    std::array<double, 8> in{};
+    double result = 0.0;
+    const auto nanoseconds = nanoseconds_per_call(1, [&](std::size_t /*i*/) {
+        for (std::size_t k = 0; k < in.size(); ++k) {
+            in[k] = static_cast<double>(k) + 1e-9 * result;
+        }
+        result = evaluate_mixing<Expression>(in);
+    });
+    checksum += result;
+    return nanoseconds;
+}
+
+// independent evaluations, limited by the number of operations
+template <typename Expression>
+double mixing_throughput(double& checksum)
+{
+    constexpr std::size_t lanes = 8;
+    std::array<std::array<double, 8>, lanes> in{};
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+        for (std::size_t k = 0; k < 8; ++k) {
+            in[lane][k] = static_cast<double>(lane + k);
+        }
+    }
+    const auto nanoseconds = nanoseconds_per_call(lanes, [&](std::size_t i) {
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            in[lane][0] = static_cast<double>(i & 1023U);
+            checksum += evaluate_mixing<Expression>(in[lane]);
+        }
+    });
+    return nanoseconds;
+}
+
+} // namespace
+
+int main()
+{
+    using Sys = codys::StateSpaceSystemOf<DenebMotion>;
+    constexpr std::size_t inputSize = Sys::stateSize + Sys::controlSize;
+
+    std::istringstream config(denebConfig);
+    auto runtime = codys::RuntimeModel::parse(config).compile();
+
+    std::array<double, inputSize> in{ 1.0, -2.0, 0.3, 4.0, 0.1, 0.2, 50.0 };
+    std::array<double, Sys::stateSize> out{};
+    double checksum = 0.0;
+
+    const auto compiled = nanoseconds_per_call(1, [&](std::size_t i) {
+        perturb(in, 1, i);
+        Sys::evaluate(in, out);
+        checksum += std::accumulate(out.begin(), out.end(), 0.0);
+    });
+
+    const auto interpreted = nanoseconds_per_call(1, [&](std::size_t i) {
+        perturb(in, 1, i);
+        runtime.evaluate(in, out);
+        checksum += std::accumulate(out.begin(), out.end(), 0.0);
+    });
+
+    constexpr std::size_t lanes = 8;
+    std::array<double, inputSize * lanes> batchIn{};
+    for (std::size_t q = 0; q < inputSize; ++q) {
+        std::ranges::fill_n(batchIn.begin() + static_cast<std::ptrdiff_t>(q * lanes), lanes, in[q]);
+    }
+    std::array<double, Sys::stateSize * lanes> batchOut{};
+    const auto batched = nanoseconds_per_call(lanes, [&](std::size_t i) {
+        perturb(batchIn, lanes, i);
+        runtime.evaluate_batch<lanes>(batchIn, batchOut);
+        checksum += std::accumulate(batchOut.begin(), batchOut.end(), 0.0);
+    });
+
+    fmt::print("DenebMotion, ns per evaluation\n");
+    fmt::print("  StateSpaceSystem::evaluate      {:8.2f}\n", compiled);
+    fmt::print("  BytecodeSystem::evaluate        {:8.2f} ({:.2f}x)\n", interpreted, interpreted / compiled);
+    fmt::print("  BytecodeSystem::evaluate_batch  {:8.2f} ({:.2f}x, {} lanes)\n", batched, batched / compiled, lanes);
+
+    using Balanced = codys::schedule_t<Mixing::Chain, false>;
+    using Fused = codys::schedule_t<Mixing::Chain, true>;
+#if defined(FP_FAST_FMA)
+    constexpr auto fmaKind = "an instruction";
+#else
+    constexpr auto fmaKind = "a library call, build with -march for FP_FAST_FMA";
+#endif
+    fmt::print("Weighted sum of 8 products, ns per evaluation (fma is {})\n", fmaKind);
+    fmt::print("                                   latency  throughput\n");
+    fmt::print("  chain as combined               {:8.2f}    {:8.2f}\n",
+               mixing_latency<Mixing::Chain>(checksum), mixing_throughput<Mixing::Chain>(checksum));
+    fmt::print("  balanced                        {:8.2f}    {:8.2f}\n",
+               mixing_latency<Balanced>(checksum), mixing_throughput<Balanced>(checksum));
+    fmt::print("  balanced and fused              {:8.2f}    {:8.2f}\n",
+               mixing_latency<Fused>(checksum), mixing_throughput<Fused>(checksum));
+
+    // one hour of straight-propeller turning, fine RK4 at 1 ms
+    constexpr double horizon = 3600.0;
+    constexpr std::size_t fineSteps = 3'600'000;
+    constexpr std::array initial{ 1.0, -2.0, 0.3, 4.0, 0.1 };
+    constexpr std::array controls{ 0.0, 50.0 };
+    auto serial = initial;
+    const auto serialSeconds = seconds([&] {
+        for (std::size_t n = 0; n < fineSteps; ++n) {
+            codys::RungeKutta4::step<Sys>(serial, controls, horizon / static_cast<double>(fineSteps));
+        }
+    });
+
+    // Heun at 0.5 s; slices divide both step counts, so the fine step stays
+    // exactly the 1 ms of the serial reference
+    constexpr std::size_t coarseSteps = 7200;
+    static_assert(fineSteps % coarseSteps == 0);
+    codys::ThreadPool pool;
+    auto slices = std::min(4 * pool.concurrency(), coarseSteps);
+    while (coarseSteps % slices != 0) {
+        --slices;
+    }
+    auto parallel = initial;
+    codys::PararealReport report{};
+    const auto pararealSeconds = seconds([&] {
+        report = codys::parareal<Sys>(pool, parallel, controls, 0.0, horizon,
+                                      codys::PararealOptions{.slices = slices,
+                                                             .coarseSteps = coarseSteps / slices,
+                                                             .fineSteps = fineSteps / slices,
+                                                             .tolerance = 1e-9});
+    });
+    double deviation = 0.0;
+    for (std::size_t i = 0; i < serial.size(); ++i) {
+        deviation = std::max(deviation, std::abs(parallel[i] - serial[i]) / std::max(1.0, std::abs(serial[i])));
+    }
+
+    fmt::print("DenebMotion, {} s with RK4 at 1 ms\n", horizon);
+    fmt::print("  serial                          {:8.3f} s\n", serialSeconds);
+    fmt::print("  parareal                        {:8.3f} s ({:.2f}x speedup, {} threads, {} slices, {} iterations, deviation {:.1e})\n",
+               pararealSeconds, serialSeconds / pararealSeconds, pool.concurrency(), slices, report.iterations, deviation);
+    if (pool.concurrency() < 2) {
+        fmt::print("  (a single thread only shows the overhead, run on several cores for the speedup)\n");
+    }
+    fmt::print("checksum {}\n", checksum + serial[0] + parallel[0]);
+}
@@ -0,0 +1,46 @@
+# Compares the build time of CONSUMERS translation units that use the
+# 100-state model directly with the same units using the thin
+# SystemInterface plus the one unit instantiating the model.
+#
+# Invoked by the build_time_report target with CXX, FLAGS, INCLUDES,
+# DEFINITIONS (lists joined with '|'), SOURCE_DIR, BINARY_DIR and CONSUMERS.
+
+string(REPLACE "|" ";" FLAGS "${FLAGS}")
+string(REPLACE "|" ";" INCLUDES "${INCLUDES}")
+string(REPLACE "|" ";" DEFINITIONS "${DEFINITIONS}")
+
+set(arguments ${FLAGS})
+foreach(include IN LISTS INCLUDES)
+  list(APPEND arguments "-I${include}")
+endforeach()
+foreach(definition IN LISTS DEFINITIONS)
+  list(APPEND arguments "-D${definition}")
+endforeach()
+
+# compile time of one translation unit in milliseconds
+function(compile_time source result)
+  string(TIMESTAMP start "%s%f" UTC)
+  execute_process(
+    COMMAND "${CXX}" ${arguments} -c "${SOURCE_DIR}/${source}" -o "${BINARY_DIR}/${source}.o"
+    RESULT_VARIABLE status
+    ERROR_VARIABLE errors)
+  string(TIMESTAMP stop "%s%f" UTC)
+  if(NOT status EQUAL 0)
+    message(FATAL_ERROR "compiling ${source} failed:\n${errors}")
+  endif()
+  math(EXPR elapsed "(${stop} - ${start}) / 1000")
+  set(${result} ${elapsed} PARENT_SCOPE)
+endfunction()
+
+compile_time(direct_consumer.cpp direct)
+compile_time(chain100_instance.cpp instance)
+compile_time(thin_consumer.cpp thin)
+
+math(EXPR directTotal "${CONSUMERS} * ${direct}")
+math(EXPR thinTotal "${instance} + ${CONSUMERS} * ${thin}")
+math(EXPR saved "${directTotal} - ${thinTotal}")
+
+message("100-state model, ${CONSUMERS} consumer translation units")
+message("  direct: ${direct} ms per unit, ${directTotal} ms in total")
+message("  thin:   ${thin} ms per unit + ${instance} ms for the instance, ${thinTotal} ms in total")
+message("  saved:  ${saved} ms")
@@ -0,0 +1,48 @@
+#pragma once
+
+// 100-state model for the build time report: a ring of coupled positions
+// x_i with dot(x_i) = k (x_{i+1} - x_i) + v cos(theta).
+
+#include <units/isq/si/length.h>
+#include <units/isq/si/speed.h>
+#include <units/isq/si/time.h>
+#include <units/generic/angle.h>
+
+#include <codys/Derivative.hpp>
+#include <codys/Operators.hpp>
+#include <codys/Quantity.hpp>
+#include <codys/StateSpaceSystem.hpp>
+
+#include <cstddef>
+#include <ratio>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace chain100
+{
+
+constexpr std::size_t stateCount = 100;
+
+template <std::size_t idx>
+using Position = codys::Quantity<std::integral_constant<std::size_t, idx>, units::isq::si::length<units::isq::si::metre>>;
+using Drift = codys::Quantity<class Drift_, units::isq::si::speed<units::isq::si::metre_per_second>, "v">;
+using Heading = codys::Quantity<class Heading_, units::angle<units::radian, double>, "\\theta">;
+
+using per_second_unit = std::remove_cvref_t<decltype(1 / units::isq::si::time<units::isq::si::second>(1))>;
+using Coupling = codys::ScalarValue<std::ratio<1, 4>, per_second_unit>;
+
+struct Chain
+{
+    constexpr static auto make_dot()
+    {
+        return []<std::size_t... idx>(std::index_sequence<idx...> /*states*/) {
+            return std::make_tuple(codys::dot<Position<idx>>(
+                Coupling{} * (Position<(idx + 1) % stateCount>{} - Position<idx>{}) + Drift{} * codys::cos(Heading{}))...);
+        }(std::make_index_sequence<stateCount>{});
+    }
+};
+
+using System = codys::StateSpaceSystemOf<Chain>;
+
+} // namespace chain100
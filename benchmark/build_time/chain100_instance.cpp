@@ -0,0 +1,11 @@
+// The one translation unit instantiating the model for the thin interface.
+#include "chain100_interface.hpp"
+#include "Chain100.hpp"
+
+#include <codys/SystemInstance.hpp>
+
+const codys::SystemInterface& chain100_system()
+{
+    constexpr static auto instance = codys::make_system_interface<chain100::System>();
+    return instance;
+}
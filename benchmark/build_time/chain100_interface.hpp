@@ -0,0 +1,5 @@
+#pragma once
+
+#include <codys/SystemInterface.hpp>
+
+const codys::SystemInterface& chain100_system();
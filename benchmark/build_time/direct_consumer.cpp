@@ -0,0 +1,18 @@
+// A translation unit using the model directly: it instantiates evaluate,
+// jacobian and format of the 100-state system itself.
+#include "Chain100.hpp"
+
+#include <codys/Jacobian.hpp>
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+std::size_t direct_consumer(const std::array<double, 102>& in)
+{
+    std::array<double, 100> out{};
+    static std::array<double, 100 * 102> jac{};
+    chain100::System::evaluate(in, out);
+    codys::jacobian<chain100::System>(in, jac);
+    return chain100::System::format().size() + static_cast<std::size_t>(out[0] + jac[0]);
+}
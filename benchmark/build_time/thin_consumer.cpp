@@ -0,0 +1,16 @@
+// The same use as direct_consumer.cpp, through the thin interface.
+#include "chain100_interface.hpp"
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+std::size_t thin_consumer(const std::array<double, 102>& in)
+{
+    std::array<double, 100> out{};
+    static std::array<double, 100 * 102> jac{};
+    const auto& system = chain100_system();
+    system.evaluate(in, out);
+    system.jacobian(in, jac);
+    return system.format().size() + static_cast<std::size_t>(out[0] + jac[0]);
+}
@@ -0,0 +1,571 @@
+#pragma once
+
+#include <codys/Operators.hpp>
+#include <codys/Quantity.hpp>
+#include <codys/StateSpaceSystem.hpp>
+#include <codys/Table.hpp>
+
+#include <fmt/format.h>
+
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+namespace detail
+{
+
+constexpr std::string_view kernel_zero = "0.0";
+constexpr std::string_view kernel_one = "1.0";
+
+// Collects the statements of one generated function. Every composite
+// subexpression becomes a named temporary; structurally identical ones are
+// emitted once, since their operands are already named.
+class KernelWriter
+{
+public:
+    std::string hoist(const std::string& expression)
+    {
+        const auto [it, inserted] = temporaries_.try_emplace(expression, fmt::format("t{}", temporaries_.size()));
+        if (inserted) {
+            body_ += fmt::format("    const double {} = {};\n", it->second, expression);
+        }
+        return it->second;
+    }
+
+    void assign(std::string_view target, std::string_view value)
+    {
+        body_ += fmt::format("    {} = {};\n", target, value);
+    }
+
+    std::string binary(std::string_view op, std::string lhs, std::string rhs, bool commutative)
+    {
+        if (commutative && rhs < lhs) {
+            std::swap(lhs, rhs);
+        }
+        return hoist(fmt::format("{} {} {}", lhs, op, rhs));
+    }
+
+    std::string add(const std::string& lhs, const std::string& rhs)
+    {
+        if (lhs == kernel_zero) {
+            return rhs;
+        }
+        if (rhs == kernel_zero) {
+            return lhs;
+        }
+        return binary("+", lhs, rhs, true);
+    }
+
+    std::string substract(const std::string& lhs, const std::string& rhs)
+    {
+        if (rhs == kernel_zero) {
+            return lhs;
+        }
+        if (lhs == kernel_zero) {
+            return hoist(fmt::format("-({})", rhs));
+        }
+        return binary("-", lhs, rhs, false);
+    }
+
+    std::string multiply(const std::string& lhs, const std::string& rhs)
+    {
+        if (lhs == kernel_zero || rhs == kernel_zero) {
+            return std::string(kernel_zero);
+        }
+        if (lhs == kernel_one) {
+            return rhs;
+        }
+        if (rhs == kernel_one) {
+            return lhs;
+        }
+        return binary("*", lhs, rhs, true);
+    }
+
+    std::string divide(const std::string& lhs, const std::string& rhs)
+    {
+        if (lhs == kernel_zero) {
+            return std::string(kernel_zero);
+        }
+        return binary("/", lhs, rhs, false);
+    }
+
+    [[nodiscard]] const std::string& body() const
+    {
+        return body_;
+    }
+
+private:
+    std::map<std::string, std::string, std::less<>> temporaries_;
+    std::string body_;
+};
+
+// C literal reading back as value; inf and nan use the macros of math.h
+inline std::string kernel_literal(double value)
+{
+    if (std::isnan(value)) {
+        return "NAN";
+    }
+    if (std::isinf(value)) {
+        return value > 0.0 ? "INFINITY" : "(-INFINITY)";
+    }
+    auto literal = fmt::format("{}", value);
+    if (literal.find_first_of(".e") == std::string::npos) {
+        literal += ".0";
+    }
+    return literal;
+}
+
+// Emits the value of an expression node and its derivative with respect to
+// input slot `input`, element-wise like evaluate().
+template <typename Expression>
+struct kernel_node;
+
+template <typename Tag, typename Unit_, StringLiteral symbol>
+struct kernel_node<Quantity<Tag, Unit_, symbol>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& /*writer*/, std::size_t /*element*/)
+    {
+        return fmt::format("in[{}]", get_offset<Quantity<Tag, Unit_, symbol>, SystemType>());
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& /*writer*/, std::size_t /*element*/, std::size_t input)
+    {
+        return std::string(get_offset<Quantity<Tag, Unit_, symbol>, SystemType>() == input ? kernel_one : kernel_zero);
+    }
+};
+
+template <typename Tag, typename Unit_, std::size_t N, StringLiteral symbol>
+struct kernel_node<QuantityArray<Tag, Unit_, N, symbol>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& /*writer*/, std::size_t element)
+    {
+        return fmt::format("in[{}]", get_offset<QuantityArray<Tag, Unit_, N, symbol>, SystemType>() + element);
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& /*writer*/, std::size_t element, std::size_t input)
+    {
+        const auto slot = get_offset<QuantityArray<Tag, Unit_, N, symbol>, SystemType>() + element;
+        return std::string(slot == input ? kernel_one : kernel_zero);
+    }
+};
+
+template <typename Operand, typename Tau>
+struct kernel_node<Delayed<Operand, Tau>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& /*writer*/, std::size_t element)
+    {
+        return fmt::format("in[{}]", get_offset<Delayed<Operand, Tau>, SystemType>() + element);
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& /*writer*/, std::size_t element, std::size_t input)
+    {
+        const auto slot = get_offset<Delayed<Operand, Tau>, SystemType>() + element;
+        return std::string(slot == input ? kernel_one : kernel_zero);
+    }
+};
+
+template <typename value_, typename Unit_>
+struct kernel_node<ScalarValue<value_, Unit_>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& /*writer*/, std::size_t /*element*/)
+    {
+        return kernel_literal(ScalarValue<value_, Unit_>::value);
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& /*writer*/, std::size_t /*element*/, std::size_t /*input*/)
+    {
+        return std::string(kernel_zero);
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct kernel_node<Add<Lhs, Rhs>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t element)
+    {
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        return writer.binary("+", lhs, rhs, true);
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& writer, std::size_t element, std::size_t input)
+    {
+        const auto dLhs = kernel_node<Lhs>::template derivative<SystemType>(writer, element, input);
+        const auto dRhs = kernel_node<Rhs>::template derivative<SystemType>(writer, element, input);
+        return writer.add(dLhs, dRhs);
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct kernel_node<Substract<Lhs, Rhs>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t element)
+    {
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        return writer.binary("-", lhs, rhs, false);
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& writer, std::size_t element, std::size_t input)
+    {
+        const auto dLhs = kernel_node<Lhs>::template derivative<SystemType>(writer, element, input);
+        const auto dRhs = kernel_node<Rhs>::template derivative<SystemType>(writer, element, input);
+        return writer.substract(dLhs, dRhs);
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct kernel_node<Multiply<Lhs, Rhs>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t element)
+    {
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        return writer.binary("*", lhs, rhs, true);
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& writer, std::size_t element, std::size_t input)
+    {
+        const auto dLhs = kernel_node<Lhs>::template derivative<SystemType>(writer, element, input);
+        const auto dRhs = kernel_node<Rhs>::template derivative<SystemType>(writer, element, input);
+        if (dLhs == kernel_zero && dRhs == kernel_zero) {
+            return std::string(kernel_zero);
+        }
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        const auto first = writer.multiply(dLhs, rhs);
+        const auto second = writer.multiply(lhs, dRhs);
+        return writer.add(first, second);
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct kernel_node<Divide<Lhs, Rhs>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t element)
+    {
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        return writer.binary("/", lhs, rhs, false);
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& writer, std::size_t element, std::size_t input)
+    {
+        const auto dLhs = kernel_node<Lhs>::template derivative<SystemType>(writer, element, input);
+        const auto dRhs = kernel_node<Rhs>::template derivative<SystemType>(writer, element, input);
+        const auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        if (dRhs == kernel_zero) {
+            return writer.divide(dLhs, rhs);
+        }
+        // (lhs / rhs)' = (lhs' - (lhs / rhs) * rhs') / rhs
+        const auto quotient = value<SystemType>(writer, element);
+        const auto numerator = writer.substract(dLhs, writer.multiply(quotient, dRhs));
+        return writer.divide(numerator, rhs);
+    }
+};
+
+template <typename Lhs, typename Rhs, typename Addend>
+struct kernel_node<FusedMultiplyAdd<Lhs, Rhs, Addend>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t element)
+    {
+        auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        const auto addend = kernel_node<Addend>::template value<SystemType>(writer, element);
+        if (rhs < lhs) {
+            std::swap(lhs, rhs);
+        }
+        return writer.hoist(fmt::format("fma({}, {}, {})", lhs, rhs, addend));
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& writer, std::size_t element, std::size_t input)
+    {
+        const auto product = kernel_node<Multiply<Lhs, Rhs>>::template derivative<SystemType>(writer, element, input);
+        const auto dAddend = kernel_node<Addend>::template derivative<SystemType>(writer, element, input);
+        return writer.add(product, dAddend);
+    }
+};
+
+template <typename Lhs>
+struct kernel_node<Sinus<Lhs>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t element)
+    {
+        return writer.hoist(fmt::format("sin({})", kernel_node<Lhs>::template value<SystemType>(writer, element)));
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& writer, std::size_t element, std::size_t input)
+    {
+        const auto dLhs = kernel_node<Lhs>::template derivative<SystemType>(writer, element, input);
+        if (dLhs == kernel_zero) {
+            return dLhs;
+        }
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto cosinus = writer.hoist(fmt::format("cos({})", lhs));
+        return writer.multiply(cosinus, dLhs);
+    }
+};
+
+template <typename Lhs>
+struct kernel_node<Cosinus<Lhs>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t element)
+    {
+        return writer.hoist(fmt::format("cos({})", kernel_node<Lhs>::template value<SystemType>(writer, element)));
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& writer, std::size_t element, std::size_t input)
+    {
+        const auto dLhs = kernel_node<Lhs>::template derivative<SystemType>(writer, element, input);
+        if (dLhs == kernel_zero) {
+            return dLhs;
+        }
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto sinus = writer.hoist(fmt::format("sin({})", lhs));
+        return writer.substract(std::string(kernel_zero), writer.multiply(sinus, dLhs));
+    }
+};
+
+template <typename Lhs>
+struct kernel_node<Sum<Lhs>>
+{
+    // same summation order as Sum::evaluate, so results match bit for bit
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t /*element*/)
+    {
+        auto result = kernel_node<Lhs>::template value<SystemType>(writer, 0);
+        for (std::size_t element = 1; element < extent_v<Lhs>; ++element) {
+            result = writer.binary("+", result, kernel_node<Lhs>::template value<SystemType>(writer, element), false);
+        }
+        return result;
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& writer, std::size_t /*element*/, std::size_t input)
+    {
+        auto result = std::string(kernel_zero);
+        for (std::size_t element = 0; element < extent_v<Lhs>; ++element) {
+            result = writer.add(result, kernel_node<Lhs>::template derivative<SystemType>(writer, element, input));
+        }
+        return result;
+    }
+};
+
+// min, max and select pick the derivative of the operand they pick
+template <typename Lhs, typename Rhs>
+struct kernel_node<Min<Lhs, Rhs>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t element)
+    {
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        return writer.hoist(fmt::format("{} < {} ? {} : {}", rhs, lhs, rhs, lhs));
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& writer, std::size_t element, std::size_t input)
+    {
+        const auto dLhs = kernel_node<Lhs>::template derivative<SystemType>(writer, element, input);
+        const auto dRhs = kernel_node<Rhs>::template derivative<SystemType>(writer, element, input);
+        if (dLhs == dRhs) {
+            return dLhs;
+        }
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        return writer.hoist(fmt::format("{} < {} ? {} : {}", rhs, lhs, dRhs, dLhs));
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct kernel_node<Max<Lhs, Rhs>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t element)
+    {
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        return writer.hoist(fmt::format("{} < {} ? {} : {}", lhs, rhs, rhs, lhs));
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& writer, std::size_t element, std::size_t input)
+    {
+        const auto dLhs = kernel_node<Lhs>::template derivative<SystemType>(writer, element, input);
+        const auto dRhs = kernel_node<Rhs>::template derivative<SystemType>(writer, element, input);
+        if (dLhs == dRhs) {
+            return dLhs;
+        }
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        return writer.hoist(fmt::format("{} < {} ? {} : {}", lhs, rhs, dRhs, dLhs));
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct kernel_node<Less<Lhs, Rhs>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t element)
+    {
+        const auto lhs = kernel_node<Lhs>::template value<SystemType>(writer, element);
+        const auto rhs = kernel_node<Rhs>::template value<SystemType>(writer, element);
+        return writer.hoist(fmt::format("{} < {} ? 1.0 : 0.0", lhs, rhs));
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& /*writer*/, std::size_t /*element*/, std::size_t /*input*/)
+    {
+        return std::string(kernel_zero);
+    }
+};
+
+template <typename Condition, typename OnTrue, typename OnFalse>
+struct kernel_node<Select<Condition, OnTrue, OnFalse>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& writer, std::size_t element)
+    {
+        const auto condition = kernel_node<Condition>::template value<SystemType>(writer, element);
+        const auto onTrue = kernel_node<OnTrue>::template value<SystemType>(writer, element);
+        const auto onFalse = kernel_node<OnFalse>::template value<SystemType>(writer, element);
+        return writer.hoist(fmt::format("{} != 0.0 ? {} : {}", condition, onTrue, onFalse));
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& writer, std::size_t element, std::size_t input)
+    {
+        const auto dTrue = kernel_node<OnTrue>::template derivative<SystemType>(writer, element, input);
+        const auto dFalse = kernel_node<OnFalse>::template derivative<SystemType>(writer, element, input);
+        if (dTrue == dFalse) {
+            return dTrue;
+        }
+        const auto condition = kernel_node<Condition>::template value<SystemType>(writer, element);
+        return writer.hoist(fmt::format("{} != 0.0 ? {} : {}", condition, dTrue, dFalse));
+    }
+};
+
+template <typename Table, typename... Arguments>
+struct kernel_node<Lookup<Table, Arguments...>>
+{
+    template <class SystemType>
+    static std::string value(KernelWriter& /*writer*/, std::size_t /*element*/)
+    {
+        static_assert(sizeof(Table) == 0, "table lookups cannot be emitted into a standalone kernel");
+        return {};
+    }
+
+    template <class SystemType>
+    static std::string derivative(KernelWriter& /*writer*/, std::size_t /*element*/, std::size_t /*input*/)
+    {
+        static_assert(sizeof(Table) == 0, "table lookups cannot be emitted into a standalone kernel");
+        return {};
+    }
+};
+
+template <typename System, typename Func>
+void for_each_equation_row(Func&& func)
+{
+    using Derivatives = std::remove_cvref_t<decltype(System::derivativeFunctions)>;
+    [&func]<std::size_t... equationIdx>(std::index_sequence<equationIdx...> /*equations*/) {
+        ([&func]<typename DerivativeType>() {
+            constexpr auto outIdx = get_offset<typename DerivativeType::Operand, typename System::AllStates>();
+            for (std::size_t element = 0; element < DerivativeType::extent; ++element) {
+                func.template operator()<typename DerivativeType::Expression>(outIdx + element, element);
+            }
+        }.template operator()<std::tuple_element_t<equationIdx, Derivatives>>(), ...);
+    }(std::make_index_sequence<System::derivativeFunctionsSize>{});
+}
+
+template <typename System>
+std::string kernel_layout_comment()
+{
+    std::string result = "/* in:";
+    std::apply([&result](auto... quantities) {
+        ((result += fmt::format(" [{}] {}", get_offset<decltype(quantities), typename System::AllStates>(), quantities)), ...);
+    }, typename System::AllStates{});
+    return result + " */\n";
+}
+
+} // namespace detail
+
+struct KernelOptions
+{
+    bool jacobian = false;
+};
+
+// Emits a dependency-free C source (also valid C++) with
+//   void <name>(const double* in, double* out)
+// evaluating the system like StateSpaceSystem::evaluate, and optionally
+//   void <name>_jacobian(const double* in, double* jac)
+// writing d out / d in row-major, stateSize x (stateSize + controlSize).
+// QuantityArray equations and sums are unrolled element by element.
+template <typename System>
+std::string generate_kernel(std::string_view name, KernelOptions options = {})
+{
+    constexpr auto inputSize = System::stateSize + System::controlSize;
+
+    std::string result = "#include <math.h>\n\n";
+    result += detail::kernel_layout_comment<System>();
+    result += "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n";
+
+    {
+        detail::KernelWriter writer;
+        detail::for_each_equation_row<System>([&writer]<typename Expression>(std::size_t row, std::size_t element) {
+            writer.assign(fmt::format("out[{}]", row),
+                          detail::kernel_node<Expression>::template value<typename System::AllStates>(writer, element));
+        });
+        result += fmt::format("void {}(const double* in, double* out)\n{{\n{}}}\n", name, writer.body());
+    }
+
+    if (options.jacobian) {
+        detail::KernelWriter writer;
+        detail::for_each_equation_row<System>([&writer]<typename Expression>(std::size_t row, std::size_t element) {
+            for (std::size_t input = 0; input < inputSize; ++input) {
+                const auto entry = detail::kernel_node<Expression>::template derivative<typename System::AllStates>(writer, element, input);
+                if (entry != detail::kernel_zero) {
+                    writer.assign(fmt::format("jac[{}]", row * inputSize + input), entry);
+                }
+            }
+        });
+        result += fmt::format("\nvoid {}_jacobian(const double* in, double* jac)\n{{\n"
+                              "    (void)in; /* unused when the system is linear */\n"
+                              "    for (int idx = 0; idx < {}; ++idx) {{\n        jac[idx] = 0.0;\n    }}\n{}}}\n",
+                              name, System::stateSize * inputSize, writer.body());
+    }
+
+    result += "\n#ifdef __cplusplus\n}\n#endif\n";
+    return result;
+}
+
+} // namespace codys
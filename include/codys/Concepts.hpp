@@ -2,10 +2,15 @@
 
 #include <codys/tuple_utilities.hpp>
 
+#include <units/isq/si/time.h>
+
 #include <algorithm>
+#include <concepts>
+#include <cstddef>
 #include <span>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 namespace codys {
 
@@ -76,7 +81,7 @@ using derivative_in_time_t = decltype(std::declval<Unit>() / (units::isq::si::ti
 
 
 template<class T, tuple_like Tuple>
-static constexpr auto get_operator_idx()
+constexpr auto get_operator_idx()
 {
     return detail::TagIndex<T, Tuple>::index;
 }
@@ -86,6 +91,37 @@ concept PhysicalType = requires {
     typename T::Unit;
 };
 
+template <typename T>
+concept has_extent = requires {
+    { T::extent } -> std::convertible_to<std::size_t>;
+};
+
+// number of consecutive slots a quantity (or expression) occupies in the state span
+template <typename T>
+constexpr std::size_t extent_v = 1;
+
+template <has_extent T>
+constexpr std::size_t extent_v<T> = T::extent;
+
+template <typename... Expression>
+constexpr std::size_t common_extent_v = std::max({std::size_t{1}, extent_v<Expression>...});
+
+template <typename... Expression>
+concept compatible_extents = ((extent_v<Expression> == 1 || extent_v<Expression> == common_extent_v<Expression...>) && ...);
+
+template <tuple_like Tuple>
+constexpr std::size_t slot_count_v = []<std::size_t... idx>(std::index_sequence<idx...> /*indices*/) {
+    return (std::size_t{0} + ... + extent_v<std::tuple_element_t<idx, Tuple>>);
+}(std::make_index_sequence<std::tuple_size_v<Tuple>>{});
+
+template<class T, tuple_like Tuple>
+constexpr std::size_t get_offset()
+{
+    return []<std::size_t... idx>(std::index_sequence<idx...> /*preceding*/) {
+        return (std::size_t{0} + ... + extent_v<std::tuple_element_t<idx, Tuple>>);
+    }(std::make_index_sequence<get_idx<T, Tuple>()>{});
+}
+
 template <typename SystemType>
 concept TypeIndexedList = requires(SystemType sys) {
    {get_idx<std::remove_cvref_t<decltype(std::get<0>(sys))>, SystemType>()} -> std::same_as<std::size_t>;
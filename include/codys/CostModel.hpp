@@ -0,0 +1,261 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Operators.hpp>
+#include <codys/Quantity.hpp>
+#include <codys/Table.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+// relative cost of one operation in units of one floating point add
+struct cost_weights
+{
+    constexpr static std::size_t add = 1;
+    constexpr static std::size_t multiply = 1;
+    constexpr static std::size_t divide = 4;
+    constexpr static std::size_t transcendental = 20;
+    constexpr static std::size_t fused_multiply_add = 1;
+};
+
+struct OperationCounts
+{
+    std::size_t adds{0}; // additions and subtractions
+    std::size_t multiplies{0};
+    std::size_t divides{0};
+    std::size_t transcendentals{0};
+    std::size_t fusedMultiplyAdds{0};
+    std::size_t depth{0}; // longest chain of dependent operations
+
+    [[nodiscard]] constexpr std::size_t operations() const
+    {
+        return adds + multiplies + divides + transcendentals + fusedMultiplyAdds;
+    }
+
+    [[nodiscard]] constexpr std::size_t weighted() const
+    {
+        return adds * cost_weights::add + multiplies * cost_weights::multiply +
+               divides * cost_weights::divide + transcendentals * cost_weights::transcendental +
+               fusedMultiplyAdds * cost_weights::fused_multiply_add;
+    }
+
+    constexpr bool operator==(const OperationCounts&) const = default;
+
+    // operations of both, evaluated independently of each other
+    friend constexpr OperationCounts operator+(const OperationCounts& lhs, const OperationCounts& rhs)
+    {
+        return {lhs.adds + rhs.adds, lhs.multiplies + rhs.multiplies, lhs.divides + rhs.divides,
+                lhs.transcendentals + rhs.transcendentals, lhs.fusedMultiplyAdds + rhs.fusedMultiplyAdds,
+                std::max(lhs.depth, rhs.depth)};
+    }
+
+    // `factor` independent evaluations, e.g. the elements of an array expression
+    friend constexpr OperationCounts operator*(std::size_t factor, const OperationCounts& counts)
+    {
+        return {factor * counts.adds, factor * counts.multiplies, factor * counts.divides,
+                factor * counts.transcendentals, factor * counts.fusedMultiplyAdds, counts.depth};
+    }
+};
+
+template <typename Expression>
+struct expression_cost;
+
+template <typename Expression>
+constexpr OperationCounts expression_cost_v = expression_cost<Expression>::value;
+
+namespace detail
+{
+
+constexpr OperationCounts one_operation(std::size_t OperationCounts::*kind, const OperationCounts& operands)
+{
+    auto result = operands;
+    ++(result.*kind);
+    ++result.depth;
+    return result;
+}
+
+} // namespace detail
+
+template <typename Tag, typename Unit_, StringLiteral symbol>
+struct expression_cost<Quantity<Tag, Unit_, symbol>>
+{
+    constexpr static OperationCounts value{};
+};
+
+template <typename Tag, typename Unit_, std::size_t N, StringLiteral symbol>
+struct expression_cost<QuantityArray<Tag, Unit_, N, symbol>>
+{
+    constexpr static OperationCounts value{};
+};
+
+template <typename Operand, typename Tau>
+struct expression_cost<Delayed<Operand, Tau>>
+{
+    constexpr static OperationCounts value{};
+};
+
+template <typename value_, typename Unit_>
+struct expression_cost<ScalarValue<value_, Unit_>>
+{
+    constexpr static OperationCounts value{};
+};
+
+template <typename Lhs, typename Rhs>
+struct expression_cost<Add<Lhs, Rhs>>
+{
+    constexpr static OperationCounts value = detail::one_operation(&OperationCounts::adds, expression_cost_v<Lhs> + expression_cost_v<Rhs>);
+};
+
+template <typename Lhs, typename Rhs>
+struct expression_cost<Substract<Lhs, Rhs>>
+{
+    constexpr static OperationCounts value = detail::one_operation(&OperationCounts::adds, expression_cost_v<Lhs> + expression_cost_v<Rhs>);
+};
+
+template <typename Lhs, typename Rhs>
+struct expression_cost<Multiply<Lhs, Rhs>>
+{
+    constexpr static OperationCounts value = detail::one_operation(&OperationCounts::multiplies, expression_cost_v<Lhs> + expression_cost_v<Rhs>);
+};
+
+template <typename Lhs, typename Rhs>
+struct expression_cost<Divide<Lhs, Rhs>>
+{
+    constexpr static OperationCounts value = detail::one_operation(&OperationCounts::divides, expression_cost_v<Lhs> + expression_cost_v<Rhs>);
+};
+
+template <typename Lhs, typename Rhs, typename Addend>
+struct expression_cost<FusedMultiplyAdd<Lhs, Rhs, Addend>>
+{
+    constexpr static OperationCounts value = detail::one_operation(
+        &OperationCounts::fusedMultiplyAdds, expression_cost_v<Lhs> + expression_cost_v<Rhs> + expression_cost_v<Addend>);
+};
+
+template <typename Lhs>
+struct expression_cost<Sinus<Lhs>>
+{
+    constexpr static OperationCounts value = detail::one_operation(&OperationCounts::transcendentals, expression_cost_v<Lhs>);
+};
+
+template <typename Lhs>
+struct expression_cost<Cosinus<Lhs>>
+{
+    constexpr static OperationCounts value = detail::one_operation(&OperationCounts::transcendentals, expression_cost_v<Lhs>);
+};
+
+// Sum::evaluate accumulates the elements one after another
+template <typename Lhs>
+struct expression_cost<Sum<Lhs>>
+{
+    constexpr static OperationCounts value = []() {
+        auto result = extent_v<Lhs> * expression_cost_v<Lhs>;
+        result.adds += extent_v<Lhs>;
+        result.depth += extent_v<Lhs>;
+        return result;
+    }();
+};
+
+// comparisons, min/max and blends cost about as much as an add
+template <typename Lhs, typename Rhs>
+struct expression_cost<Min<Lhs, Rhs>>
+{
+    constexpr static OperationCounts value = detail::one_operation(&OperationCounts::adds, expression_cost_v<Lhs> + expression_cost_v<Rhs>);
+};
+
+template <typename Lhs, typename Rhs>
+struct expression_cost<Max<Lhs, Rhs>>
+{
+    constexpr static OperationCounts value = detail::one_operation(&OperationCounts::adds, expression_cost_v<Lhs> + expression_cost_v<Rhs>);
+};
+
+template <typename Lhs, typename Rhs>
+struct expression_cost<Less<Lhs, Rhs>>
+{
+    constexpr static OperationCounts value = detail::one_operation(&OperationCounts::adds, expression_cost_v<Lhs> + expression_cost_v<Rhs>);
+};
+
+template <typename Condition, typename OnTrue, typename OnFalse>
+struct expression_cost<Select<Condition, OnTrue, OnFalse>>
+{
+    constexpr static OperationCounts value = detail::one_operation(
+        &OperationCounts::adds, expression_cost_v<Condition> + expression_cost_v<OnTrue> + expression_cost_v<OnFalse>);
+};
+
+// a lookup costs about as much as a transcendental function
+template <typename Table, typename... Arguments>
+struct expression_cost<Lookup<Table, Arguments...>>
+{
+    constexpr static OperationCounts value = detail::one_operation(&OperationCounts::transcendentals, (OperationCounts{} + ... + expression_cost_v<Arguments>));
+};
+
+// Dispatching a batch to a thread pool costs a few microseconds, which is in
+// the order of several thousand additions.
+constexpr std::size_t parallel_evaluation_threshold = 8192;
+
+// equation groups of a parallel evaluation, enough to balance the work of a
+// typical pool over its threads
+constexpr std::size_t parallel_evaluation_groups = 16;
+
+// element-wise equations with at least this many elements vectorize well
+constexpr std::size_t simd_extent_threshold = 4;
+
+enum class EvaluationStrategy
+{
+    Scalar,
+    Simd,
+    Threaded,
+};
+
+// Static operation counts of a StateSpaceSystem, e.g. for
+//   static_assert(system_cost<Sys>::total.transcendentals <= 4);
+template <typename System>
+struct system_cost
+{
+    using Derivatives = std::remove_cvref_t<decltype(System::derivativeFunctions)>;
+    constexpr static std::size_t equationCount = std::tuple_size_v<Derivatives>;
+
+    // all elements of an array equation
+    constexpr static auto equations = []<std::size_t... idx>(std::index_sequence<idx...> /*equations*/) {
+        return std::array<OperationCounts, equationCount>{
+            (std::tuple_element_t<idx, Derivatives>::extent *
+             expression_cost_v<typename std::tuple_element_t<idx, Derivatives>::Expression>)...};
+    }(std::make_index_sequence<equationCount>{});
+
+    // distinct quantities an equation reads
+    constexpr static auto fanIn = []<std::size_t... idx>(std::index_sequence<idx...> /*equations*/) {
+        return std::array<std::size_t, equationCount>{
+            std::tuple_size_v<typename std::tuple_element_t<idx, Derivatives>::depends_on>...};
+    }(std::make_index_sequence<equationCount>{});
+
+    constexpr static std::size_t maxExtent = []<std::size_t... idx>(std::index_sequence<idx...> /*equations*/) {
+        return std::max({std::size_t{1}, std::tuple_element_t<idx, Derivatives>::extent...});
+    }(std::make_index_sequence<equationCount>{});
+
+    constexpr static OperationCounts total = []() {
+        OperationCounts result{};
+        for (const auto& equation : equations) {
+            result = result + equation;
+        }
+        return result;
+    }();
+
+    constexpr static std::size_t maxFanIn = std::ranges::max(fanIn);
+
+    constexpr static std::size_t weightedCost = total.weighted();
+
+    // Threaded pays off for expensive systems only; it additionally needs
+    // more than one equation group, see equation_partition.
+    constexpr static EvaluationStrategy strategy =
+        weightedCost >= parallel_evaluation_threshold ? EvaluationStrategy::Threaded
+        : maxExtent >= simd_extent_threshold          ? EvaluationStrategy::Simd
+                                                      : EvaluationStrategy::Scalar;
+};
+
+} // namespace codys
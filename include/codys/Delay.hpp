@@ -0,0 +1,193 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Integrator.hpp>
+#include <codys/Quantity.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+namespace detail
+{
+
+template <typename T>
+struct is_delayed : std::false_type
+{
+};
+
+template <typename Operand, typename Tau>
+struct is_delayed<Delayed<Operand, Tau>> : std::true_type
+{
+};
+
+// a control slot holding a state slot of System at t - delay
+struct DelayedSlot
+{
+    std::size_t input;
+    std::size_t state;
+    double delay;
+};
+
+template <typename System>
+constexpr auto delayed_slots = []() {
+    using AllStates = typename System::AllStates;
+    return []<std::size_t... idx>(std::index_sequence<idx...> /*quantities*/) {
+        constexpr auto count = (std::size_t{0} + ... +
+                                (is_delayed<std::tuple_element_t<idx, AllStates>>::value ? extent_v<std::tuple_element_t<idx, AllStates>> : 0));
+        std::array<DelayedSlot, count> result{};
+        std::size_t next = 0;
+        ([&]<typename T>() {
+            if constexpr (is_delayed<T>::value) {
+                constexpr auto state = get_offset<typename T::Operand, AllStates>();
+                static_assert(state < System::stateSize, "only states can be delayed");
+                for (std::size_t element = 0; element < T::extent; ++element) {
+                    result[next++] = {get_offset<T, AllStates>() + element, state + element, T::delay};
+                }
+            }
+        }.template operator()<std::tuple_element_t<idx, AllStates>>(), ...);
+        return result;
+    }(std::make_index_sequence<std::tuple_size_v<AllStates>>{});
+}();
+
+} // namespace detail
+
+// Fixed-step RK4 for systems with Delayed terms. Every step stores the
+// delayed states and their derivatives in a ring buffer of `capacity` points
+// allocated with the integrator; the Delayed slots of each stage are filled
+// by cubic Hermite interpolation on that history at the stage time minus the
+// delay, through a cursor per slot that only moves forward. Before t0 the
+// history is constant at the initial states. The values passed in the
+// Delayed slots of the controls are ignored.
+template <typename System, std::size_t capacity>
+class DelayIntegrator
+{
+public:
+    constexpr static auto slots = detail::delayed_slots<System>;
+    constexpr static std::size_t delayedCount = slots.size();
+    constexpr static std::size_t inputSize = System::stateSize + System::controlSize;
+
+    static_assert(capacity >= 2);
+
+    // throws std::invalid_argument if dt exceeds the shortest delay or the
+    // history cannot span the longest one
+    constexpr DelayIntegrator(std::span<const double, System::stateSize> initialStates, double t0, double dt)
+        : t0_(t0), dt_(dt)
+    {
+        if (!(dt > 0.0)) {
+            throw std::invalid_argument("step size must be positive");
+        }
+        for (const auto& slot : slots) {
+            if (dt > slot.delay) {
+                throw std::invalid_argument("step size exceeds the shortest delay");
+            }
+            if (static_cast<double>(capacity - 2) * dt < slot.delay) {
+                throw std::invalid_argument("history capacity does not span the longest delay");
+            }
+        }
+        for (std::size_t i = 0; i < delayedCount; ++i) {
+            initial_[i] = initialStates[slots[i].state];
+        }
+        push(initialStates);
+    }
+
+    [[nodiscard]] constexpr double time() const
+    {
+        return t0_ + static_cast<double>(count_ - 1) * dt_;
+    }
+
+    // advances states, which must be those of the previous step, by dt
+    constexpr void step(std::span<double, System::stateSize> states, std::span<const double, System::controlSize> controls)
+    {
+        const double t = time();
+        std::array<double, inputSize> in{};
+        std::ranges::copy(controls, in.begin() + System::stateSize);
+
+        state_vector_t<System> k1{};
+        state_vector_t<System> k2{};
+        state_vector_t<System> k3{};
+        state_vector_t<System> k4{};
+        const auto stage = [&](std::span<const double, System::stateSize> direction, double scale, double at,
+                               std::span<double, System::stateSize> derivativesOut) {
+            for (std::size_t i = 0; i < System::stateSize; ++i) {
+                in[i] = states[i] + scale * direction[i];
+            }
+            for (std::size_t i = 0; i < delayedCount; ++i) {
+                in[slots[i].input] = lookup(i, at - slots[i].delay);
+            }
+            System::evaluate(in, derivativesOut);
+        };
+        stage(k1, 0.0, t, k1);
+        // the derivative at the newest point completes its history entry
+        auto& newest = history_[(count_ - 1) % capacity];
+        for (std::size_t i = 0; i < delayedCount; ++i) {
+            newest.derivative[i] = k1[slots[i].state];
+        }
+        stage(k1, dt_ / 2.0, t + dt_ / 2.0, k2);
+        stage(k2, dt_ / 2.0, t + dt_ / 2.0, k3);
+        stage(k3, dt_, t + dt_, k4);
+        for (std::size_t i = 0; i < System::stateSize; ++i) {
+            states[i] += dt_ / 6.0 * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]);
+        }
+        push(states);
+    }
+
+private:
+    struct Point
+    {
+        std::array<double, delayedCount> value{};
+        std::array<double, delayedCount> derivative{};
+    };
+
+    constexpr void push(std::span<const double, System::stateSize> states)
+    {
+        auto& point = history_[count_ % capacity];
+        for (std::size_t i = 0; i < delayedCount; ++i) {
+            point.value[i] = states[slots[i].state];
+            point.derivative[i] = 0.0;
+        }
+        ++count_;
+    }
+
+    // delayed slot i at time t, which is at most the time of the newest point
+    constexpr double lookup(std::size_t i, double t)
+    {
+        if (t <= t0_) {
+            return initial_[i];
+        }
+        auto& cursor = cursors_[i];
+        while (cursor + 1 < count_ && t0_ + static_cast<double>(cursor + 1) * dt_ <= t) {
+            ++cursor;
+        }
+        const auto& from = history_[cursor % capacity];
+        if (cursor + 1 == count_) {
+            return from.value[i];
+        }
+        const auto& to = history_[(cursor + 1) % capacity];
+        const double theta = (t - t0_) / dt_ - static_cast<double>(cursor);
+        const double theta2 = theta * theta;
+        const double theta3 = theta2 * theta;
+        return (2.0 * theta3 - 3.0 * theta2 + 1.0) * from.value[i] +
+               (theta3 - 2.0 * theta2 + theta) * dt_ * from.derivative[i] +
+               (-2.0 * theta3 + 3.0 * theta2) * to.value[i] +
+               (theta3 - theta2) * dt_ * to.derivative[i];
+    }
+
+    double t0_;
+    double dt_;
+    // points pushed so far; the newest is at (count_ - 1) % capacity
+    std::size_t count_{0};
+    std::array<Point, capacity> history_{};
+    std::array<double, delayedCount> initial_{};
+    std::array<std::size_t, delayedCount> cursors_{};
+};
+
+} // namespace codys
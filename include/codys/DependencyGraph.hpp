@@ -0,0 +1,187 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Quantity.hpp>
+#include <codys/StateSpaceSystem.hpp>
+#include <codys/tuple_utilities.hpp>
+
+#include <units/bits/unit_text.h>
+
+#include <fmt/format.h>
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+namespace detail
+{
+
+template <typename T>
+struct quantity_symbol
+{
+    constexpr static std::string_view value{};
+};
+
+template <typename Tag, typename Unit_, StringLiteral symbol>
+struct quantity_symbol<Quantity<Tag, Unit_, symbol>>
+{
+    constexpr static std::string_view value = symbol.toStringView();
+};
+
+template <typename Tag, typename Unit_, std::size_t N, StringLiteral symbol>
+struct quantity_symbol<QuantityArray<Tag, Unit_, N, symbol>>
+{
+    constexpr static std::string_view value = symbol.toStringView();
+};
+
+// same text as mp-units prints behind the number of a quantity
+template <typename Unit>
+std::string unit_symbol()
+{
+    constexpr auto text = units::detail::unit_text<typename Unit::dimension, typename Unit::unit>();
+    const std::string result = text.standard().c_str();
+    return result.empty() ? "1" : result;
+}
+
+template <typename System>
+struct graph_nodes
+{
+    using AllStates = typename System::AllStates;
+    using Derivatives = std::remove_cvref_t<decltype(System::derivativeFunctions)>;
+    constexpr static std::size_t quantityCount = std::tuple_size_v<AllStates>;
+    // one equation per state, the remaining quantities are controls
+    constexpr static std::size_t stateCount = std::tuple_size_v<Derivatives>;
+
+    template <std::size_t idx>
+    static std::string symbol()
+    {
+        constexpr auto text = quantity_symbol<std::tuple_element_t<idx, AllStates>>::value;
+        return text.empty() ? fmt::format("q{}", idx) : std::string(text);
+    }
+};
+
+inline std::string escape(std::string_view text)
+{
+    std::string result;
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result;
+}
+
+} // namespace detail
+
+// dependency_matrix<System>[equation][quantity] is set when the derivative
+// equation reads the quantity; quantities are indexed as in AllStates.
+template <typename System>
+constexpr auto dependency_matrix = []() {
+    using Derivatives = std::remove_cvref_t<decltype(System::derivativeFunctions)>;
+    using AllStates = typename System::AllStates;
+    return []<std::size_t... equationIdx>(std::index_sequence<equationIdx...> /*equations*/) {
+        return std::array<std::array<bool, std::tuple_size_v<AllStates>>, sizeof...(equationIdx)>{
+            []<typename... Dependency>(std::tuple<Dependency...> /*dependencies*/) {
+                std::array<bool, std::tuple_size_v<AllStates>> row{};
+                ((row[get_idx<Dependency, AllStates>()] = true), ...);
+                return row;
+            }(typename std::tuple_element_t<equationIdx, Derivatives>::depends_on{})...};
+    }(std::make_index_sequence<std::tuple_size_v<Derivatives>>{});
+}();
+
+template <typename System>
+constexpr std::size_t dependency_count = []() {
+    std::size_t count = 0;
+    for (const auto& row : dependency_matrix<System>) {
+        for (const bool dependency : row) {
+            count += dependency ? 1 : 0;
+        }
+    }
+    return count;
+}();
+
+namespace detail
+{
+
+// Calls func(id, kind, symbol, unit, extent) for every quantity and every
+// derivative node of the bipartite graph, then edge(from, to) for every
+// dependency. Ids follow format_in: quantities first, derivatives behind.
+template <typename System, typename NodeFunc, typename EdgeFunc>
+void visit_dependency_graph(NodeFunc&& node, EdgeFunc&& edge)
+{
+    using Nodes = graph_nodes<System>;
+    using Derivatives = typename Nodes::Derivatives;
+    constexpr auto quantityCount = Nodes::quantityCount;
+
+    [&node]<std::size_t... idx>(std::index_sequence<idx...> /*quantities*/) {
+        ((node(idx, idx < Nodes::stateCount ? "state" : "control", Nodes::template symbol<idx>(),
+               unit_symbol<typename std::tuple_element_t<idx, typename Nodes::AllStates>::Unit>(),
+               extent_v<std::tuple_element_t<idx, typename Nodes::AllStates>>)), ...);
+    }(std::make_index_sequence<quantityCount>{});
+
+    [&node]<std::size_t... equationIdx>(std::index_sequence<equationIdx...> /*equations*/) {
+        ((node(quantityCount + get_idx<typename std::tuple_element_t<equationIdx, Derivatives>::Operand, typename Nodes::AllStates>(),
+               "derivative",
+               fmt::format("\\dot({})", Nodes::template symbol<get_idx<typename std::tuple_element_t<equationIdx, Derivatives>::Operand, typename Nodes::AllStates>()>()),
+               unit_symbol<typename std::tuple_element_t<equationIdx, Derivatives>::Unit>(),
+               std::tuple_element_t<equationIdx, Derivatives>::extent)), ...);
+    }(std::make_index_sequence<std::tuple_size_v<Derivatives>>{});
+
+    constexpr auto operands = []<std::size_t... equationIdx>(std::index_sequence<equationIdx...> /*equations*/) {
+        return std::array<std::size_t, sizeof...(equationIdx)>{
+            get_idx<typename std::tuple_element_t<equationIdx, Derivatives>::Operand, typename Nodes::AllStates>()...};
+    }(std::make_index_sequence<std::tuple_size_v<Derivatives>>{});
+
+    for (std::size_t eq = 0; eq < operands.size(); ++eq) {
+        for (std::size_t quantity = 0; quantity < quantityCount; ++quantity) {
+            if (dependency_matrix<System>[eq][quantity]) {
+                edge(quantity, quantityCount + operands[eq]);
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+// Graphviz DOT of the state/control -> derivative dependencies
+template <typename System>
+std::string dependency_graph_dot()
+{
+    std::string result = "digraph dependencies {\n  rankdir=LR;\n";
+    detail::visit_dependency_graph<System>(
+        [&result](std::size_t id, std::string_view kind, const std::string& symbol, const std::string& unit, std::size_t extent) {
+            const auto shape = kind == "derivative" ? "box" : (kind == "control" ? "diamond" : "ellipse");
+            const auto size = extent > 1 ? fmt::format("[{}]", extent) : std::string{};
+            result += fmt::format("  n{} [label=\"{}{} [{}]\", shape={}];\n", id, detail::escape(symbol), size, detail::escape(unit), shape);
+        },
+        [&result](std::size_t from, std::size_t to) {
+            result += fmt::format("  n{} -> n{};\n", from, to);
+        });
+    return result + "}\n";
+}
+
+template <typename System>
+std::string dependency_graph_json()
+{
+    std::string nodes;
+    std::string edges;
+    detail::visit_dependency_graph<System>(
+        [&nodes](std::size_t id, std::string_view kind, const std::string& symbol, const std::string& unit, std::size_t extent) {
+            nodes += fmt::format("{}\n    {{\"id\": {}, \"kind\": \"{}\", \"symbol\": \"{}\", \"unit\": \"{}\", \"extent\": {}}}",
+                                 nodes.empty() ? "" : ",", id, kind, detail::escape(symbol), detail::escape(unit), extent);
+        },
+        [&edges](std::size_t from, std::size_t to) {
+            edges += fmt::format("{}\n    {{\"from\": {}, \"to\": {}}}", edges.empty() ? "" : ",", from, to);
+        });
+    return fmt::format("{{\n  \"nodes\": [{}\n  ],\n  \"edges\": [{}\n  ]\n}}\n", nodes, edges);
+}
+
+} // namespace codys
@@ -26,11 +26,15 @@ struct Derivative
     using depends_on = to_unique_tuple_t<typename Expression::depends_on>;
     using Operand = Operand_;
     using Unit = detail::derivative_in_time_t<typename Operand::Unit>;
+    constexpr static std::size_t extent = extent_v<Operand>;
+
+    static_assert(compatible_extents<Operand, Expression>,
+                  "expression of an array derivative must be scalar or of the operand's extent");
 
     template <class SystemType, std::size_t N>
-    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr)
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
     {
-        return Expression::template evaluate<SystemType>(arr);
+        return Expression::template evaluate<SystemType>(arr, element);
     }
 
     template <class SystemType>
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <codys/Integrator.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <utility>
+
+namespace codys
+{
+
+enum class EventDirection
+{
+    Rising,  // g goes from negative to zero or positive
+    Falling, // g goes from positive to zero or negative
+    Either,
+};
+
+enum class EventAction
+{
+    Stop,     // terminal: integration ends at the event
+    Continue, // reported, integration goes on
+};
+
+// Zero crossing of an expression over the states and controls of a system,
+// e.g. event<EventDirection::Rising>(Velocity{} - SpeedLimit{}).
+template <typename Expression, EventDirection direction = EventDirection::Either, EventAction action = EventAction::Stop>
+struct Event
+{
+    using depends_on = typename Expression::depends_on;
+    constexpr static bool terminal = action == EventAction::Stop;
+
+    template <class SystemType, std::size_t N>
+    [[nodiscard]] constexpr static double evaluate(std::span<const double, N> arr)
+    {
+        return Expression::template evaluate<SystemType>(arr);
+    }
+
+    [[nodiscard]] constexpr static bool crosses(double before, double after)
+    {
+        const bool rising = before < 0.0 && after >= 0.0;
+        const bool falling = before > 0.0 && after <= 0.0;
+        if constexpr (direction == EventDirection::Rising) {
+            return rising;
+        } else if constexpr (direction == EventDirection::Falling) {
+            return falling;
+        } else {
+            return rising || falling;
+        }
+    }
+};
+
+template <EventDirection direction = EventDirection::Either, EventAction action = EventAction::Stop, typename Expression>
+constexpr auto event(Expression /*expression*/)
+{
+    return Event<Expression, direction, action>{};
+}
+
+namespace detail
+{
+
+// Cubic Hermite interpolation of a step from its end points and their
+// derivatives, at theta in [0, 1].
+template <std::size_t N>
+constexpr void hermite(std::span<const double, N> y0, std::span<const double, N> f0,
+                       std::span<const double, N> y1, std::span<const double, N> f1,
+                       double h, double theta, std::span<double, N> out)
+{
+    const double theta2 = theta * theta;
+    const double theta3 = theta2 * theta;
+    const double h00 = 2.0 * theta3 - 3.0 * theta2 + 1.0;
+    const double h10 = theta3 - 2.0 * theta2 + theta;
+    const double h01 = -2.0 * theta3 + 3.0 * theta2;
+    const double h11 = theta3 - theta2;
+    for (std::size_t i = 0; i < N; ++i) {
+        out[i] = h00 * y0[i] + h10 * h * f0[i] + h01 * y1[i] + h11 * h * f1[i];
+    }
+}
+
+// Illinois variant of regula falsi on [0, 1] with g(0) and g(1) of opposite
+// sign (or g(1) == 0).
+template <typename Func>
+constexpr double illinois(Func&& g, double g0, double g1)
+{
+    constexpr double tolerance = 1e-12;
+    constexpr std::size_t maxIterations = 100;
+
+    double a = 0.0;
+    double b = 1.0;
+    double ga = g0;
+    double gb = g1;
+    int side = 0;
+    for (std::size_t iteration = 0; iteration < maxIterations && b - a > tolerance; ++iteration) {
+        const double c = (a * gb - b * ga) / (gb - ga);
+        const double gc = g(c);
+        if (gc == 0.0) {
+            return c;
+        }
+        if ((gc > 0.0) == (gb > 0.0)) {
+            b = c;
+            gb = gc;
+            if (side == -1) {
+                ga /= 2.0;
+            }
+            side = -1;
+        } else {
+            a = c;
+            ga = gc;
+            if (side == 1) {
+                gb /= 2.0;
+            }
+            side = 1;
+        }
+    }
+    // the end that is on the far side of the crossing
+    return b;
+}
+
+} // namespace detail
+
+// Integrates from t0 towards tEnd with fixed steps dt (the last one
+// shortened) and locates the zero crossings of events within each step on
+// the Hermite interpolant of the step. For every crossing, in time order,
+// onEvent(eventIdx, time, states) is called with the interpolated states.
+// At the first terminal event the states are set to the interpolated
+// states and its time is returned, otherwise tEnd. Costs one evaluation
+// per step in addition to the stepper; two crossings of one event within a
+// single step cancel out and are not detected.
+template <typename System, FixedStepper<System> Stepper = RungeKutta4, typename... Events, typename OnEvent>
+constexpr double integrate_with_events(
+    std::span<double, System::stateSize> states,
+    std::span<const double, System::controlSize> controls,
+    double t0, double tEnd, double dt,
+    std::tuple<Events...> /*events*/,
+    OnEvent&& onEvent)
+{
+    using AllStates = typename System::AllStates;
+    constexpr auto stateSize = System::stateSize;
+    constexpr auto inputSize = System::stateSize + System::controlSize;
+    constexpr auto eventCount = sizeof...(Events);
+    constexpr std::array<bool, eventCount> terminal{Events::terminal...};
+    constexpr std::array<bool (*)(double, double), eventCount> crosses{&Events::crosses...};
+    constexpr std::array<double (*)(std::span<const double, inputSize>), eventCount> functions{
+        &Events::template evaluate<AllStates, inputSize>...};
+
+    std::array<double, inputSize> in{};
+    std::ranges::copy(controls, in.begin() + stateSize);
+    const auto evaluate_event = [&in, &functions](std::size_t idx, std::span<const double, stateSize> at) {
+        std::ranges::copy(at, in.begin());
+        return functions[idx](in);
+    };
+    const auto evaluate_events = [&evaluate_event](std::span<const double, stateSize> at) {
+        std::array<double, eventCount> result{};
+        for (std::size_t idx = 0; idx < eventCount; ++idx) {
+            result[idx] = evaluate_event(idx, at);
+        }
+        return result;
+    };
+
+    state_vector_t<System> y0{};
+    state_vector_t<System> f0{};
+    state_vector_t<System> f1{};
+    state_vector_t<System> dense{};
+    std::ranges::copy(states, y0.begin());
+    evaluate_at<System>(y0, controls, f0);
+    auto g0 = evaluate_events(y0);
+
+    double t = t0;
+    while (t < tEnd) {
+        const double h = std::min(dt, tEnd - t);
+        Stepper::template step<System>(states, controls, h);
+        evaluate_at<System>(states, controls, f1);
+        const auto g1 = evaluate_events(states);
+
+        // crossings of this step, located on the interpolant
+        std::array<std::pair<double, std::size_t>, eventCount> found{};
+        std::size_t foundCount = 0;
+        for (std::size_t idx = 0; idx < eventCount; ++idx) {
+            if (crosses[idx](g0[idx], g1[idx])) {
+                const auto g = [&](double theta) {
+                    detail::hermite<stateSize>(y0, f0, states, f1, h, theta, dense);
+                    return evaluate_event(idx, dense);
+                };
+                found[foundCount++] = {detail::illinois(g, g0[idx], g1[idx]), idx};
+            }
+        }
+        std::sort(found.begin(), found.begin() + static_cast<std::ptrdiff_t>(foundCount));
+
+        for (std::size_t n = 0; n < foundCount; ++n) {
+            const auto [theta, idx] = found[n];
+            detail::hermite<stateSize>(y0, f0, states, f1, h, theta, dense);
+            onEvent(idx, t + theta * h, std::span<const double, stateSize>(dense));
+            if (terminal[idx]) {
+                std::ranges::copy(dense, states.begin());
+                return t + theta * h;
+            }
+        }
+
+        t += h;
+        std::ranges::copy(states, y0.begin());
+        f0 = f1;
+        g0 = g1;
+    }
+    return tEnd;
+}
+
+template <typename System, FixedStepper<System> Stepper = RungeKutta4, typename... Events>
+constexpr double integrate_with_events(
+    std::span<double, System::stateSize> states,
+    std::span<const double, System::controlSize> controls,
+    double t0, double tEnd, double dt,
+    std::tuple<Events...> events)
+{
+    return integrate_with_events<System, Stepper>(states, controls, t0, tEnd, dt, events,
+                                                  [](std::size_t /*eventIdx*/, double /*time*/, std::span<const double, System::stateSize> /*states*/) {});
+}
+
+} // namespace codys
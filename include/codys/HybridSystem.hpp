@@ -0,0 +1,217 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Events.hpp>
+#include <codys/Integrator.hpp>
+#include <codys/StateSpaceSystem.hpp>
+#include <codys/tuple_utilities.hpp>
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+// Assigns Operand the value of Expression when a transition is taken. All
+// resets of a transition read the values from before the transition.
+template <PhysicalType Operand_, typename Expression_>
+struct Reset
+{
+    using Operand = Operand_;
+    using Expression = Expression_;
+    static_assert(std::is_same_v<typename Operand::Unit, typename Expression::Unit>,
+                  "reset expression must have the unit of the reset quantity");
+    static_assert(extent_v<Operand> == 1, "reset of QuantityArray is not supported");
+
+    template <class SystemType, std::size_t N, std::size_t StateSize>
+    constexpr static void apply(std::span<const double, N> before, std::span<double, StateSize> states)
+    {
+        states[get_offset<Operand, SystemType>()] = Expression::template evaluate<SystemType>(before);
+    }
+};
+
+template <PhysicalType Operand, typename Expression>
+constexpr auto reset(Expression /*expression*/)
+{
+    return Reset<Operand, Expression>{};
+}
+
+// Switch from mode `from` to mode `to` when Guard crosses zero in its
+// direction, applying Resets to the states at the crossing.
+template <std::size_t from_, std::size_t to_, typename Guard_, typename... Resets>
+struct Transition
+{
+    constexpr static std::size_t from = from_;
+    constexpr static std::size_t to = to_;
+    using Guard = Guard_;
+
+    template <class SystemType, std::size_t N, std::size_t StateSize>
+    constexpr static void apply([[maybe_unused]] std::span<const double, N> before,
+                                [[maybe_unused]] std::span<double, StateSize> states)
+    {
+        (Resets::template apply<SystemType>(before, states), ...);
+    }
+};
+
+template <std::size_t from, std::size_t to, typename Expression, EventDirection direction, EventAction action, typename... Resets>
+constexpr auto transition(Event<Expression, direction, action> /*guard*/, Resets... /*resets*/)
+{
+    // the continuous segment always ends at the guard
+    return Transition<from, to, Event<Expression, direction, EventAction::Stop>, Resets...>{};
+}
+
+template <TypeIndexedList States, TypeIndexedList Controls, typename Modes, typename Transitions>
+struct HybridSystem;
+
+// Modes with their own derivative equations (make_dot types) over one shared
+// layout of States and Controls. The active mode is a runtime index; every
+// per-mode operation dispatches through a table of function pointers built
+// at compile time, on the caller's state vectors.
+template <TypeIndexedList States, TypeIndexedList Controls, typename... ModeDots, typename... Transitions>
+struct HybridSystem<States, Controls, std::tuple<ModeDots...>, std::tuple<Transitions...>>
+{
+    using ModeSystems = std::tuple<StateSpaceSystem<States, Controls, ModeDots>...>;
+    using AllStates = tuple_cat_t<States, Controls>;
+    constexpr static std::size_t stateSize = slot_count_v<States>;
+    constexpr static std::size_t controlSize = slot_count_v<Controls>;
+    constexpr static std::size_t modeCount = sizeof...(ModeDots);
+    constexpr static std::size_t transitionCount = sizeof...(Transitions);
+    constexpr static std::size_t noTransition = std::numeric_limits<std::size_t>::max();
+
+    static_assert(((Transitions::from < modeCount && Transitions::to < modeCount) && ...),
+                  "transition refers to a mode that does not exist");
+
+    template <std::size_t mode>
+    using ModeSystem = std::tuple_element_t<mode, ModeSystems>;
+
+    constexpr static void evaluate(
+        std::size_t mode,
+        std::span<const double, stateSize + controlSize> statesIn,
+        std::span<double, stateSize> derivativesOut)
+    {
+        constexpr std::array<void (*)(std::span<const double, stateSize + controlSize>, std::span<double, stateSize>), modeCount>
+            table{&StateSpaceSystem<States, Controls, ModeDots>::evaluate...};
+        table[mode](statesIn, derivativesOut);
+    }
+
+    // transitions leaving `mode`, as indices into Transitions
+    template <std::size_t mode>
+    constexpr static auto outgoing = []() {
+        constexpr std::array<std::size_t, transitionCount> from{Transitions::from...};
+        constexpr auto count = static_cast<std::size_t>(std::ranges::count(from, mode));
+        std::array<std::size_t, count> result{};
+        std::size_t next = 0;
+        for (std::size_t idx = 0; idx < transitionCount; ++idx) {
+            if (from[idx] == mode) {
+                result[next++] = idx;
+            }
+        }
+        return result;
+    }();
+
+    constexpr static void apply_transition(
+        std::size_t transitionIdx,
+        std::span<double, stateSize> states,
+        std::span<const double, controlSize> controls)
+    {
+        constexpr std::array<void (*)(std::span<const double, stateSize + controlSize>, std::span<double, stateSize>), transitionCount>
+            table{&Transitions::template apply<AllStates, stateSize + controlSize, stateSize>...};
+        std::array<double, stateSize + controlSize> before{};
+        std::ranges::copy(states, before.begin());
+        std::ranges::copy(controls, before.begin() + stateSize);
+        table[transitionIdx](before, states);
+    }
+
+    constexpr static std::size_t target(std::size_t transitionIdx)
+    {
+        constexpr std::array<std::size_t, transitionCount> to{Transitions::to...};
+        return to[transitionIdx];
+    }
+
+    struct Segment
+    {
+        double time;
+        std::size_t transition;
+    };
+
+    // integrates `mode` until tEnd or the first guard of its outgoing transitions
+    template <typename Stepper>
+    constexpr static Segment integrate_mode(
+        std::size_t mode,
+        std::span<double, stateSize> states,
+        std::span<const double, controlSize> controls,
+        double t0, double tEnd, double dt)
+    {
+        constexpr auto table = []<std::size_t... modeIdx>(std::index_sequence<modeIdx...> /*modes*/) {
+            return std::array<Segment (*)(std::span<double, stateSize>, std::span<const double, controlSize>, double, double, double), modeCount>{
+                &integrate_segment<Stepper, modeIdx>...};
+        }(std::make_index_sequence<modeCount>{});
+        return table[mode](states, controls, t0, tEnd, dt);
+    }
+
+private:
+    template <typename Stepper, std::size_t mode>
+    constexpr static Segment integrate_segment(
+        std::span<double, stateSize> states,
+        std::span<const double, controlSize> controls,
+        double t0, double tEnd, double dt)
+    {
+        using Outgoing = detail::index_sequence_of<outgoing<mode>>;
+        return [&]<std::size_t... transitionIdx>(std::index_sequence<transitionIdx...> /*transitions*/) {
+            Segment segment{tEnd, noTransition};
+            segment.time = integrate_with_events<ModeSystem<mode>, Stepper>(
+                states, controls, t0, tEnd, dt,
+                std::tuple<typename std::tuple_element_t<transitionIdx, std::tuple<Transitions...>>::Guard...>{},
+                [&segment](std::size_t eventIdx, double /*time*/, std::span<const double, stateSize> /*states*/) {
+                    segment.transition = outgoing<mode>[eventIdx];
+                });
+            return segment;
+        }(Outgoing{});
+    }
+};
+
+// Integrates a HybridSystem from t0 to tEnd, starting in `mode` and
+// switching modes at the exact crossing times of the guards. Calls
+// onSwitch(from, to, time, states) after the reset of every transition and
+// returns the final mode.
+template <typename Hybrid, FixedStepper<typename Hybrid::template ModeSystem<0>> Stepper = RungeKutta4, typename OnSwitch>
+constexpr std::size_t integrate_hybrid(
+    std::size_t mode,
+    std::span<double, Hybrid::stateSize> states,
+    std::span<const double, Hybrid::controlSize> controls,
+    double t0, double tEnd, double dt,
+    OnSwitch&& onSwitch)
+{
+    double t = t0;
+    while (t < tEnd) {
+        const auto segment = Hybrid::template integrate_mode<Stepper>(mode, states, controls, t, tEnd, dt);
+        t = segment.time;
+        if (segment.transition == Hybrid::noTransition) {
+            break;
+        }
+        Hybrid::apply_transition(segment.transition, states, controls);
+        const auto from = mode;
+        mode = Hybrid::target(segment.transition);
+        onSwitch(from, mode, t, std::span<const double, Hybrid::stateSize>(states));
+    }
+    return mode;
+}
+
+template <typename Hybrid, FixedStepper<typename Hybrid::template ModeSystem<0>> Stepper = RungeKutta4>
+constexpr std::size_t integrate_hybrid(
+    std::size_t mode,
+    std::span<double, Hybrid::stateSize> states,
+    std::span<const double, Hybrid::controlSize> controls,
+    double t0, double tEnd, double dt)
+{
+    return integrate_hybrid<Hybrid, Stepper>(mode, states, controls, t0, tEnd, dt,
+                                             [](std::size_t /*from*/, std::size_t /*to*/, double /*time*/,
+                                                std::span<const double, Hybrid::stateSize> /*states*/) {});
+}
+
+} // namespace codys
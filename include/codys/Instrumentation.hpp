@@ -0,0 +1,524 @@
+#pragma once
+
+#include <codys/CostModel.hpp>
+#include <codys/Operators.hpp>
+#include <codys/Quantity.hpp>
+#include <codys/Table.hpp>
+#include <codys/StateSpaceSystem.hpp>
+
+#include <fmt/format.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace codys
+{
+
+// Instrumentation policies for Profiler.
+struct NoInstrumentation
+{
+};
+
+struct CountEvaluations
+{
+};
+
+// counts every evaluation and times each equation of every samplePeriod-th one
+template <std::size_t samplePeriod = 16, std::size_t traceCapacity = 4096>
+struct SampleCycles
+{
+    static_assert(samplePeriod >= 1);
+};
+
+enum class NodeType : std::uint8_t
+{
+    Quantity,
+    QuantityArray,
+    ScalarValue,
+    Add,
+    Substract,
+    Multiply,
+    Divide,
+    Sinus,
+    Cosinus,
+    Sum,
+    Delayed,
+    Lookup,
+    Min,
+    Max,
+    Less,
+    Select,
+    FusedMultiplyAdd,
+};
+
+constexpr std::size_t node_type_count = 17;
+
+constexpr std::array<std::string_view, node_type_count> node_type_names{
+    "Quantity", "QuantityArray", "ScalarValue", "Add", "Substract",
+    "Multiply", "Divide", "Sinus", "Cosinus", "Sum", "Delayed", "Lookup", "Min", "Max", "Less", "Select",
+    "FusedMultiplyAdd"};
+
+// weight of a node type when splitting the cycles of an equation over its
+// nodes; leaves and delay lookups count as free
+constexpr std::size_t node_type_weight(NodeType type)
+{
+    switch (type) {
+    case NodeType::Quantity:
+    case NodeType::QuantityArray:
+    case NodeType::ScalarValue:
+    case NodeType::Delayed:
+        return 0;
+    case NodeType::Add:
+    case NodeType::Substract:
+    case NodeType::Sum:
+    case NodeType::Min:
+    case NodeType::Max:
+    case NodeType::Less:
+    case NodeType::Select:
+        return cost_weights::add;
+    case NodeType::Multiply:
+        return cost_weights::multiply;
+    case NodeType::Divide:
+        return cost_weights::divide;
+    case NodeType::Sinus:
+    case NodeType::Cosinus:
+    case NodeType::Lookup:
+        return cost_weights::transcendental;
+    case NodeType::FusedMultiplyAdd:
+        return cost_weights::fused_multiply_add;
+    }
+    return 0;
+}
+
+namespace detail
+{
+
+inline std::uint64_t read_cycle_counter()
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+using NodeCounts = std::array<std::size_t, node_type_count>;
+
+constexpr NodeCounts single_node(NodeType type)
+{
+    NodeCounts counts{};
+    counts[static_cast<std::size_t>(type)] = 1;
+    return counts;
+}
+
+constexpr NodeCounts operator+(NodeCounts lhs, const NodeCounts& rhs)
+{
+    for (std::size_t i = 0; i < node_type_count; ++i) {
+        lhs[i] += rhs[i];
+    }
+    return lhs;
+}
+
+constexpr NodeCounts operator*(std::size_t factor, NodeCounts counts)
+{
+    for (auto& count : counts) {
+        count *= factor;
+    }
+    return counts;
+}
+
+// node evaluations for one evaluation of one element of an expression
+template <typename Expression>
+struct node_counts;
+
+template <typename Tag, typename Unit_, StringLiteral symbol>
+struct node_counts<Quantity<Tag, Unit_, symbol>>
+{
+    constexpr static NodeCounts value = single_node(NodeType::Quantity);
+};
+
+template <typename Tag, typename Unit_, std::size_t N, StringLiteral symbol>
+struct node_counts<QuantityArray<Tag, Unit_, N, symbol>>
+{
+    constexpr static NodeCounts value = single_node(NodeType::QuantityArray);
+};
+
+template <typename Operand, typename Tau>
+struct node_counts<Delayed<Operand, Tau>>
+{
+    constexpr static NodeCounts value = single_node(NodeType::Delayed);
+};
+
+template <typename value_, typename Unit_>
+struct node_counts<ScalarValue<value_, Unit_>>
+{
+    constexpr static NodeCounts value = single_node(NodeType::ScalarValue);
+};
+
+template <NodeType type, typename... Operand>
+constexpr NodeCounts node_with_operands = (single_node(type) + ... + node_counts<Operand>::value);
+
+template <typename Lhs, typename Rhs>
+struct node_counts<Add<Lhs, Rhs>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::Add, Lhs, Rhs>;
+};
+
+template <typename Lhs, typename Rhs>
+struct node_counts<Substract<Lhs, Rhs>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::Substract, Lhs, Rhs>;
+};
+
+template <typename Lhs, typename Rhs>
+struct node_counts<Multiply<Lhs, Rhs>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::Multiply, Lhs, Rhs>;
+};
+
+template <typename Lhs, typename Rhs>
+struct node_counts<Divide<Lhs, Rhs>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::Divide, Lhs, Rhs>;
+};
+
+template <typename Lhs, typename Rhs, typename Addend>
+struct node_counts<FusedMultiplyAdd<Lhs, Rhs, Addend>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::FusedMultiplyAdd, Lhs, Rhs, Addend>;
+};
+
+template <typename Lhs>
+struct node_counts<Sinus<Lhs>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::Sinus, Lhs>;
+};
+
+template <typename Lhs>
+struct node_counts<Cosinus<Lhs>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::Cosinus, Lhs>;
+};
+
+template <typename Lhs>
+struct node_counts<Sum<Lhs>>
+{
+    constexpr static NodeCounts value = single_node(NodeType::Sum) + extent_v<Lhs> * node_counts<Lhs>::value;
+};
+
+template <typename Lhs, typename Rhs>
+struct node_counts<Min<Lhs, Rhs>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::Min, Lhs, Rhs>;
+};
+
+template <typename Lhs, typename Rhs>
+struct node_counts<Max<Lhs, Rhs>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::Max, Lhs, Rhs>;
+};
+
+template <typename Lhs, typename Rhs>
+struct node_counts<Less<Lhs, Rhs>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::Less, Lhs, Rhs>;
+};
+
+template <typename Condition, typename OnTrue, typename OnFalse>
+struct node_counts<Select<Condition, OnTrue, OnFalse>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::Select, Condition, OnTrue, OnFalse>;
+};
+
+template <typename Table, typename... Arguments>
+struct node_counts<Lookup<Table, Arguments...>>
+{
+    constexpr static NodeCounts value = node_with_operands<NodeType::Lookup, Arguments...>;
+};
+
+inline std::string json_escape(std::string_view text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (const char c : text) {
+        switch (c) {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        default:
+            result += c;
+        }
+    }
+    return result;
+}
+
+template <typename System>
+struct equation_info
+{
+    using Derivatives = std::remove_cvref_t<decltype(System::derivativeFunctions)>;
+
+    template <std::size_t equationIdx>
+    using derivative_t = std::tuple_element_t<equationIdx, Derivatives>;
+
+    // "{3} = {0} * \cos({2})", without the trailing ";\n" of format_in
+    template <std::size_t equationIdx>
+    static std::string text()
+    {
+        constexpr auto formatted = derivative_t<equationIdx>::template format_in<typename System::AllStates>();
+        const auto view = toView(formatted);
+        return std::string(view.substr(0, view.find(';')));
+    }
+
+    template <std::size_t equationIdx>
+    static std::string operand()
+    {
+        return fmt::format("{}", typename derivative_t<equationIdx>::Operand{});
+    }
+
+    // node evaluations of all elements of one equation
+    template <std::size_t equationIdx>
+    constexpr static NodeCounts nodes = derivative_t<equationIdx>::extent * node_counts<typename derivative_t<equationIdx>::Expression>::value;
+};
+
+} // namespace detail
+
+// Evaluates System like System::evaluate while recording per equation
+// statistics according to Policy. Not thread safe; use one per thread.
+template <typename System, typename Policy = CountEvaluations>
+class Profiler;
+
+template <typename System>
+class Profiler<System, NoInstrumentation>
+{
+public:
+    constexpr static void evaluate(
+        std::span<const double, System::stateSize + System::controlSize> statesIn,
+        std::span<double, System::stateSize> derivativesOut)
+    {
+        System::evaluate(statesIn, derivativesOut);
+    }
+};
+
+template <typename System, typename Policy>
+class Profiler
+{
+    constexpr static bool timed = !std::is_same_v<Policy, CountEvaluations>;
+
+    template <typename T>
+    struct sample_parameters
+    {
+        constexpr static std::size_t period = 1;
+        constexpr static std::size_t capacity = 1;
+    };
+
+    template <std::size_t samplePeriod, std::size_t traceCapacity>
+    struct sample_parameters<SampleCycles<samplePeriod, traceCapacity>>
+    {
+        constexpr static std::size_t period = samplePeriod;
+        constexpr static std::size_t capacity = traceCapacity;
+    };
+
+    using Info = detail::equation_info<System>;
+
+public:
+    constexpr static std::size_t equationCount = System::derivativeFunctionsSize;
+    constexpr static std::size_t samplePeriod = sample_parameters<Policy>::period;
+
+    struct TraceEvent
+    {
+        std::uint64_t start;
+        std::uint64_t cycles;
+        std::size_t equation;
+    };
+
+    Profiler()
+        : calibrationCycles_(detail::read_cycle_counter()),
+          calibrationTime_(std::chrono::steady_clock::now())
+    {
+    }
+
+    void evaluate(
+        std::span<const double, System::stateSize + System::controlSize> statesIn,
+        std::span<double, System::stateSize> derivativesOut)
+    {
+        ++evaluations_;
+        if constexpr (timed) {
+            if (evaluations_ % samplePeriod == 0) {
+                evaluate_timed(std::make_index_sequence<equationCount>{}, statesIn, derivativesOut);
+                return;
+            }
+        }
+        System::evaluate(statesIn, derivativesOut);
+    }
+
+    [[nodiscard]] std::uint64_t evaluations() const { return evaluations_; }
+    [[nodiscard]] std::uint64_t samples(std::size_t equation) const { return samples_[equation]; }
+    [[nodiscard]] std::uint64_t cycles(std::size_t equation) const { return cycles_[equation]; }
+
+    [[nodiscard]] static std::string equation_text(std::size_t equation)
+    {
+        return [equation]<std::size_t... idx>(std::index_sequence<idx...> /*equations*/) {
+            std::string result;
+            ((idx == equation ? void(result = Info::template text<idx>()) : void()), ...);
+            return result;
+        }(std::make_index_sequence<equationCount>{});
+    }
+
+    [[nodiscard]] static std::string operand(std::size_t equation)
+    {
+        return [equation]<std::size_t... idx>(std::index_sequence<idx...> /*equations*/) {
+            std::string result;
+            ((idx == equation ? void(result = Info::template operand<idx>()) : void()), ...);
+            return result;
+        }(std::make_index_sequence<equationCount>{});
+    }
+
+    // node evaluations per type, exact
+    [[nodiscard]] std::array<std::uint64_t, node_type_count> node_evaluations() const
+    {
+        std::array<std::uint64_t, node_type_count> result{};
+        for (std::size_t type = 0; type < node_type_count; ++type) {
+            for (std::size_t eq = 0; eq < equationCount; ++eq) {
+                result[type] += evaluations_ * equationNodes[eq][type];
+            }
+        }
+        return result;
+    }
+
+    // Sampled cycles per node type. Nodes are not timed individually, since
+    // a single add is below the resolution of the counter; instead the cycles
+    // of every equation are split over its nodes by cost_weights.
+    [[nodiscard]] std::array<double, node_type_count> node_cycles() const
+    {
+        std::array<double, node_type_count> result{};
+        for (std::size_t eq = 0; eq < equationCount; ++eq) {
+            double weight = 0.0;
+            for (std::size_t type = 0; type < node_type_count; ++type) {
+                weight += static_cast<double>(equationNodes[eq][type] * nodeTypeCost[type]);
+            }
+            if (weight == 0.0) {
+                continue;
+            }
+            for (std::size_t type = 0; type < node_type_count; ++type) {
+                result[type] += static_cast<double>(cycles_[eq]) *
+                                static_cast<double>(equationNodes[eq][type] * nodeTypeCost[type]) / weight;
+            }
+        }
+        return result;
+    }
+
+    void write_json(std::ostream& out) const
+    {
+        out << fmt::format("{{\n  \"evaluations\": {},\n  \"samplePeriod\": {},\n  \"equations\": [\n",
+                           evaluations_, samplePeriod);
+        for (std::size_t eq = 0; eq < equationCount; ++eq) {
+            out << fmt::format("    {{\"index\": {}, \"operand\": \"{}\", \"equation\": \"{}\", "
+                               "\"evaluations\": {}, \"samples\": {}, \"cycles\": {}}}{}\n",
+                               eq, detail::json_escape(operand(eq)), detail::json_escape(equation_text(eq)),
+                               evaluations_, samples_[eq], cycles_[eq], eq + 1 < equationCount ? "," : "");
+        }
+        out << "  ],\n  \"nodes\": [\n";
+        const auto evaluations = node_evaluations();
+        const auto cycles = node_cycles();
+        for (std::size_t type = 0; type < node_type_count; ++type) {
+            out << fmt::format("    {{\"type\": \"{}\", \"evaluations\": {}, \"cycles\": {:.0f}}}{}\n",
+                               node_type_names[type], evaluations[type], cycles[type],
+                               type + 1 < node_type_count ? "," : "");
+        }
+        out << "  ]\n}\n";
+    }
+
+    // Chrome trace event format (chrome://tracing, Perfetto) of the most
+    // recent sampled equation evaluations.
+    void write_chrome_trace(std::ostream& out) const
+    {
+        const auto cyclesPerMicrosecond = cycles_per_microsecond();
+        const auto first = traceCount_ > traceCapacity ? traceCount_ - traceCapacity : 0;
+        out << "{\"traceEvents\": [\n";
+        for (auto idx = first; idx < traceCount_; ++idx) {
+            const auto& event = trace_[idx % traceCapacity];
+            out << fmt::format("  {{\"name\": \"{}\", \"cat\": \"equation\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, "
+                               "\"ts\": {:.3f}, \"dur\": {:.3f}, \"args\": {{\"equation\": \"{}\", \"cycles\": {}}}}}{}\n",
+                               detail::json_escape(operand(event.equation)),
+                               static_cast<double>(event.start - calibrationCycles_) / cyclesPerMicrosecond,
+                               static_cast<double>(event.cycles) / cyclesPerMicrosecond,
+                               detail::json_escape(equation_text(event.equation)), event.cycles,
+                               idx + 1 < traceCount_ ? "," : "");
+        }
+        out << "]}\n";
+    }
+
+private:
+    constexpr static std::size_t traceCapacity = sample_parameters<Policy>::capacity;
+
+    constexpr static auto equationNodes = []<std::size_t... idx>(std::index_sequence<idx...> /*equations*/) {
+        return std::array<detail::NodeCounts, equationCount>{Info::template nodes<idx>...};
+    }(std::make_index_sequence<equationCount>{});
+
+    // weights for splitting equation cycles over node types, indexed by NodeType
+    constexpr static auto nodeTypeCost = []() {
+        std::array<std::size_t, node_type_count> result{};
+        for (std::size_t type = 0; type < node_type_count; ++type) {
+            result[type] = node_type_weight(static_cast<NodeType>(type));
+        }
+        return result;
+    }();
+
+    template <std::size_t... equationIdx>
+    void evaluate_timed(
+        std::index_sequence<equationIdx...> /*equations*/,
+        std::span<const double, System::stateSize + System::controlSize> statesIn,
+        std::span<double, System::stateSize> derivativesOut)
+    {
+        ((time_equation<equationIdx>(statesIn, derivativesOut)), ...);
+    }
+
+    template <std::size_t equationIdx>
+    void time_equation(
+        std::span<const double, System::stateSize + System::controlSize> statesIn,
+        std::span<double, System::stateSize> derivativesOut)
+    {
+        const auto start = detail::read_cycle_counter();
+        System::template evaluate_equation<equationIdx>(statesIn, derivativesOut);
+        const auto elapsed = detail::read_cycle_counter() - start;
+        ++samples_[equationIdx];
+        cycles_[equationIdx] += elapsed;
+        trace_[traceCount_++ % traceCapacity] = TraceEvent{start, elapsed, equationIdx};
+    }
+
+    [[nodiscard]] double cycles_per_microsecond() const
+    {
+        const auto cycles = static_cast<double>(detail::read_cycle_counter() - calibrationCycles_);
+        const auto micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - calibrationTime_).count();
+        return micros > 0.0 && cycles > 0.0 ? cycles / micros : 1.0;
+    }
+
+    std::uint64_t evaluations_{0};
+    std::array<std::uint64_t, equationCount> samples_{};
+    std::array<std::uint64_t, equationCount> cycles_{};
+    std::array<TraceEvent, traceCapacity> trace_{};
+    std::size_t traceCount_{0};
+    std::uint64_t calibrationCycles_;
+    std::chrono::steady_clock::time_point calibrationTime_;
+};
+
+} // namespace codys
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+
+namespace codys
+{
+
+template <typename System>
+using state_vector_t = std::array<double, System::stateSize>;
+
+template <typename System>
+using control_vector_t = std::array<double, System::controlSize>;
+
+namespace detail
+{
+
+// evaluates the system at states + scale * direction, with controls held constant
+template <typename System>
+constexpr void evaluate_offset(
+    std::span<const double, System::stateSize> states,
+    std::span<const double, System::controlSize> controls,
+    std::span<const double, System::stateSize> direction,
+    double scale,
+    std::span<double, System::stateSize> derivativesOut)
+{
+    std::array<double, System::stateSize + System::controlSize> in{};
+    for (std::size_t i = 0; i < System::stateSize; ++i) {
+        in[i] = states[i] + scale * direction[i];
+    }
+    std::ranges::copy(controls, in.begin() + System::stateSize);
+    System::evaluate(in, derivativesOut);
+}
+
+} // namespace detail
+
+template <typename System>
+constexpr void evaluate_at(
+    std::span<const double, System::stateSize> states,
+    std::span<const double, System::controlSize> controls,
+    std::span<double, System::stateSize> derivativesOut)
+{
+    std::array<double, System::stateSize + System::controlSize> in{};
+    std::ranges::copy(states, in.begin());
+    std::ranges::copy(controls, in.begin() + System::stateSize);
+    System::evaluate(in, derivativesOut);
+}
+
+// Supplies the controls of System at any time, e.g. ControlSignals.
+template <typename T, typename System>
+concept ControlSource = requires(T& source, double t, std::span<double, System::controlSize> controls) {
+    source.sample(t, controls);
+};
+
+// Fixed-step one-step methods. Given a span of controls, these are held
+// constant over a step; given a ControlSource and the time of the step, the
+// controls are sampled at the time of every stage.
+struct ExplicitEuler
+{
+    template <typename System>
+    constexpr static void step(
+        std::span<double, System::stateSize> states,
+        std::span<const double, System::controlSize> controls,
+        double dt)
+    {
+        state_vector_t<System> k1{};
+        evaluate_at<System>(states, controls, k1);
+        for (std::size_t i = 0; i < System::stateSize; ++i) {
+            states[i] += dt * k1[i];
+        }
+    }
+
+    template <typename System, ControlSource<System> Source>
+    constexpr static void step(std::span<double, System::stateSize> states, Source& source, double t, double dt)
+    {
+        control_vector_t<System> controls{};
+        source.sample(t, controls);
+        step<System>(states, std::span<const double, System::controlSize>(controls), dt);
+    }
+};
+
+struct Heun
+{
+    template <typename System>
+    constexpr static void step(
+        std::span<double, System::stateSize> states,
+        std::span<const double, System::controlSize> controls,
+        double dt)
+    {
+        state_vector_t<System> k1{};
+        state_vector_t<System> k2{};
+        evaluate_at<System>(states, controls, k1);
+        detail::evaluate_offset<System>(states, controls, k1, dt, k2);
+        for (std::size_t i = 0; i < System::stateSize; ++i) {
+            states[i] += dt / 2.0 * (k1[i] + k2[i]);
+        }
+    }
+
+    template <typename System, ControlSource<System> Source>
+    constexpr static void step(std::span<double, System::stateSize> states, Source& source, double t, double dt)
+    {
+        control_vector_t<System> controls{};
+        state_vector_t<System> k1{};
+        state_vector_t<System> k2{};
+        source.sample(t, controls);
+        evaluate_at<System>(states, controls, k1);
+        source.sample(t + dt, controls);
+        detail::evaluate_offset<System>(states, controls, k1, dt, k2);
+        for (std::size_t i = 0; i < System::stateSize; ++i) {
+            states[i] += dt / 2.0 * (k1[i] + k2[i]);
+        }
+    }
+};
+
+struct RungeKutta4
+{
+    template <typename System>
+    constexpr static void step(
+        std::span<double, System::stateSize> states,
+        std::span<const double, System::controlSize> controls,
+        double dt)
+    {
+        state_vector_t<System> k1{};
+        state_vector_t<System> k2{};
+        state_vector_t<System> k3{};
+        state_vector_t<System> k4{};
+        evaluate_at<System>(states, controls, k1);
+        detail::evaluate_offset<System>(states, controls, k1, dt / 2.0, k2);
+        detail::evaluate_offset<System>(states, controls, k2, dt / 2.0, k3);
+        detail::evaluate_offset<System>(states, controls, k3, dt, k4);
+        for (std::size_t i = 0; i < System::stateSize; ++i) {
+            states[i] += dt / 6.0 * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]);
+        }
+    }
+
+    template <typename System, ControlSource<System> Source>
+    constexpr static void step(std::span<double, System::stateSize> states, Source& source, double t, double dt)
+    {
+        control_vector_t<System> controls{};
+        state_vector_t<System> k1{};
+        state_vector_t<System> k2{};
+        state_vector_t<System> k3{};
+        state_vector_t<System> k4{};
+        source.sample(t, controls);
+        evaluate_at<System>(states, controls, k1);
+        source.sample(t + dt / 2.0, controls);
+        detail::evaluate_offset<System>(states, controls, k1, dt / 2.0, k2);
+        detail::evaluate_offset<System>(states, controls, k2, dt / 2.0, k3);
+        source.sample(t + dt, controls);
+        detail::evaluate_offset<System>(states, controls, k3, dt, k4);
+        for (std::size_t i = 0; i < System::stateSize; ++i) {
+            states[i] += dt / 6.0 * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]);
+        }
+    }
+};
+
+template <typename T, typename System>
+concept FixedStepper = requires(std::span<double, System::stateSize> states,
+                                std::span<const double, System::controlSize> controls, double dt) {
+    T::template step<System>(states, controls, dt);
+};
+
+// Integrates from t0 to tEnd in steps of dt, the last one shortened to end
+// at tEnd, with the controls taken from `source` at every stage.
+template <typename System, FixedStepper<System> Stepper = RungeKutta4, ControlSource<System> Source>
+constexpr void integrate(std::span<double, System::stateSize> states, Source& source, double t0, double tEnd, double dt)
+{
+    for (double t = t0; t < tEnd;) {
+        const double h = std::min(dt, tEnd - t);
+        Stepper::template step<System>(states, source, t, h);
+        t = h < dt ? tEnd : t + h;
+    }
+}
+
+// The states at every stride-th step of dt, starting with initialStates,
+// with controls held. Usable in constant expressions, so reference
+// maneuvers or trim tables can be computed by the compiler and stored as
+// constants:
+//
+//   constexpr auto table = codys::simulate<Sys, 100, 10>(initial, controls, 0.01);
+template <typename System, std::size_t count, std::size_t stride = 1, FixedStepper<System> Stepper = RungeKutta4>
+constexpr std::array<state_vector_t<System>, count> simulate(
+    state_vector_t<System> initialStates, const control_vector_t<System>& controls, double dt)
+{
+    static_assert(stride >= 1);
+    std::array<state_vector_t<System>, count> trajectory{};
+    for (std::size_t point = 0; point < count; ++point) {
+        trajectory[point] = initialStates;
+        for (std::size_t step = 0; step < stride && point + 1 < count; ++step) {
+            Stepper::template step<System>(initialStates, controls, dt);
+        }
+    }
+    return trajectory;
+}
+
+} // namespace codys
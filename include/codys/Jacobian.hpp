@@ -0,0 +1,281 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Operators.hpp>
+#include <codys/Quantity.hpp>
+#include <codys/Table.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+// value of an expression and its derivative along one input slot
+struct Dual
+{
+    double value{0.0};
+    double derivative{0.0};
+};
+
+namespace detail
+{
+
+// Forward-mode differentiation of an expression node with respect to the
+// input slot `input`, mirroring the node's evaluate.
+template <typename Expression>
+struct forward_node;
+
+template <typename Tag, typename Unit_, StringLiteral symbol>
+struct forward_node<Quantity<Tag, Unit_, symbol>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t /*element*/, std::size_t input)
+    {
+        constexpr auto offset = get_offset<Quantity<Tag, Unit_, symbol>, SystemType>();
+        return {arr[offset], offset == input ? 1.0 : 0.0};
+    }
+};
+
+template <typename Tag, typename Unit_, std::size_t Size, StringLiteral symbol>
+struct forward_node<QuantityArray<Tag, Unit_, Size, symbol>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const auto slot = get_offset<QuantityArray<Tag, Unit_, Size, symbol>, SystemType>() + element;
+        return {arr[slot], slot == input ? 1.0 : 0.0};
+    }
+};
+
+template <typename Operand, typename Tau>
+struct forward_node<Delayed<Operand, Tau>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const auto slot = get_offset<Delayed<Operand, Tau>, SystemType>() + element;
+        return {arr[slot], slot == input ? 1.0 : 0.0};
+    }
+};
+
+template <typename value_, typename Unit_>
+struct forward_node<ScalarValue<value_, Unit_>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> /*arr*/, std::size_t /*element*/, std::size_t /*input*/)
+    {
+        return {ScalarValue<value_, Unit_>::value, 0.0};
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct forward_node<Add<Lhs, Rhs>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const auto lhs = forward_node<Lhs>::template evaluate<SystemType>(arr, element, input);
+        const auto rhs = forward_node<Rhs>::template evaluate<SystemType>(arr, element, input);
+        return {lhs.value + rhs.value, lhs.derivative + rhs.derivative};
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct forward_node<Substract<Lhs, Rhs>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const auto lhs = forward_node<Lhs>::template evaluate<SystemType>(arr, element, input);
+        const auto rhs = forward_node<Rhs>::template evaluate<SystemType>(arr, element, input);
+        return {lhs.value - rhs.value, lhs.derivative - rhs.derivative};
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct forward_node<Multiply<Lhs, Rhs>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const auto lhs = forward_node<Lhs>::template evaluate<SystemType>(arr, element, input);
+        const auto rhs = forward_node<Rhs>::template evaluate<SystemType>(arr, element, input);
+        return {lhs.value * rhs.value, lhs.derivative * rhs.value + lhs.value * rhs.derivative};
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct forward_node<Divide<Lhs, Rhs>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const auto lhs = forward_node<Lhs>::template evaluate<SystemType>(arr, element, input);
+        const auto rhs = forward_node<Rhs>::template evaluate<SystemType>(arr, element, input);
+        const auto value = lhs.value / rhs.value;
+        return {value, (lhs.derivative - value * rhs.derivative) / rhs.value};
+    }
+};
+
+template <typename Lhs, typename Rhs, typename Addend>
+struct forward_node<FusedMultiplyAdd<Lhs, Rhs, Addend>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const auto lhs = forward_node<Lhs>::template evaluate<SystemType>(arr, element, input);
+        const auto rhs = forward_node<Rhs>::template evaluate<SystemType>(arr, element, input);
+        const auto addend = forward_node<Addend>::template evaluate<SystemType>(arr, element, input);
+        return {fused_multiply_add(lhs.value, rhs.value, addend.value),
+                lhs.derivative * rhs.value + lhs.value * rhs.derivative + addend.derivative};
+    }
+};
+
+template <typename Lhs>
+struct forward_node<Sinus<Lhs>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const auto lhs = forward_node<Lhs>::template evaluate<SystemType>(arr, element, input);
+        return {std::sin(lhs.value), std::cos(lhs.value) * lhs.derivative};
+    }
+};
+
+template <typename Lhs>
+struct forward_node<Cosinus<Lhs>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const auto lhs = forward_node<Lhs>::template evaluate<SystemType>(arr, element, input);
+        return {std::cos(lhs.value), -std::sin(lhs.value) * lhs.derivative};
+    }
+};
+
+template <typename Lhs>
+struct forward_node<Sum<Lhs>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t /*element*/, std::size_t input)
+    {
+        Dual result{};
+        for (std::size_t element = 0; element < extent_v<Lhs>; ++element) {
+            const auto term = forward_node<Lhs>::template evaluate<SystemType>(arr, element, input);
+            result.value += term.value;
+            result.derivative += term.derivative;
+        }
+        return result;
+    }
+};
+
+// the derivative of the selected operand; min and max take the first on ties
+template <typename Lhs, typename Rhs>
+struct forward_node<Min<Lhs, Rhs>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const auto lhs = forward_node<Lhs>::template evaluate<SystemType>(arr, element, input);
+        const auto rhs = forward_node<Rhs>::template evaluate<SystemType>(arr, element, input);
+        return rhs.value < lhs.value ? rhs : lhs;
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct forward_node<Max<Lhs, Rhs>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const auto lhs = forward_node<Lhs>::template evaluate<SystemType>(arr, element, input);
+        const auto rhs = forward_node<Rhs>::template evaluate<SystemType>(arr, element, input);
+        return lhs.value < rhs.value ? rhs : lhs;
+    }
+};
+
+template <typename Lhs, typename Rhs>
+struct forward_node<Less<Lhs, Rhs>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t /*input*/)
+    {
+        return {Less<Lhs, Rhs>::template evaluate<SystemType>(arr, element), 0.0};
+    }
+};
+
+template <typename Condition, typename OnTrue, typename OnFalse>
+struct forward_node<Select<Condition, OnTrue, OnFalse>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const double condition = Condition::template evaluate<SystemType>(arr, element);
+        const auto onTrue = forward_node<OnTrue>::template evaluate<SystemType>(arr, element, input);
+        const auto onFalse = forward_node<OnFalse>::template evaluate<SystemType>(arr, element, input);
+        return condition != 0.0 ? onTrue : onFalse;
+    }
+};
+
+template <typename Table, typename... Arguments>
+struct forward_node<Lookup<Table, Arguments...>>
+{
+    template <class SystemType, std::size_t N>
+    constexpr static Dual evaluate(std::span<const double, N> arr, std::size_t element, std::size_t input)
+    {
+        const std::array<Dual, sizeof...(Arguments)> arguments{
+            forward_node<Arguments>::template evaluate<SystemType>(arr, element, input)...};
+        std::array<double, sizeof...(Arguments)> at{};
+        std::ranges::transform(arguments, at.begin(), &Dual::value);
+        Dual result{Table::grid.template evaluate<Table::interpolation>(at), 0.0};
+        for (std::size_t dim = 0; dim < arguments.size(); ++dim) {
+            if (arguments[dim].derivative != 0.0) {
+                result.derivative += Table::grid.template partial<Table::interpolation>(at, dim) * arguments[dim].derivative;
+            }
+        }
+        return result;
+    }
+};
+
+} // namespace detail
+
+// d out / d in of System::evaluate, row-major stateSize x (stateSize + controlSize),
+// the same layout as the generated <name>_jacobian kernel. Only the slots an
+// equation depends on are differentiated, all other entries are zero.
+template <typename System>
+constexpr void jacobian(
+    std::span<const double, System::stateSize + System::controlSize> statesIn,
+    std::span<double, System::stateSize * (System::stateSize + System::controlSize)> jacobianOut)
+{
+    using AllStates = typename System::AllStates;
+    using Derivatives = std::remove_cvref_t<decltype(System::derivativeFunctions)>;
+    constexpr auto inputSize = System::stateSize + System::controlSize;
+
+    std::ranges::fill(jacobianOut, 0.0);
+    [&]<std::size_t... equationIdx>(std::index_sequence<equationIdx...> /*equations*/) {
+        ([&]<typename DerivativeType>() {
+            constexpr auto outIdx = get_offset<typename DerivativeType::Operand, AllStates>();
+            for (std::size_t element = 0; element < DerivativeType::extent; ++element) {
+                std::apply([&](auto... dependencies) {
+                    ([&]<typename Dependency>(Dependency /*dependency*/) {
+                        constexpr auto first = get_offset<Dependency, AllStates>();
+                        for (std::size_t input = first; input < first + extent_v<Dependency>; ++input) {
+                            jacobianOut[(outIdx + element) * inputSize + input] =
+                                detail::forward_node<typename DerivativeType::Expression>::template evaluate<AllStates>(
+                                    statesIn, element, input).derivative;
+                        }
+                    }(dependencies), ...);
+                }, typename DerivativeType::depends_on{});
+            }
+        }.template operator()<std::tuple_element_t<equationIdx, Derivatives>>(), ...);
+    }(std::make_index_sequence<System::derivativeFunctionsSize>{});
+}
+
+} // namespace codys
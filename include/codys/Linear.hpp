@@ -0,0 +1,400 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Integrator.hpp>
+#include <codys/MultiRate.hpp>
+#include <codys/Operators.hpp>
+#include <codys/Quantity.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+namespace detail
+{
+
+// expression = coefficients . [states, controls] + constant, if linear
+template <std::size_t inputSize>
+struct LinearForm
+{
+    bool linear{false};
+    std::array<double, inputSize> coefficients{};
+    double constant{0.0};
+
+    [[nodiscard]] constexpr bool is_constant() const
+    {
+        return linear && std::ranges::all_of(coefficients, [](double c) { return c == 0.0; });
+    }
+
+    [[nodiscard]] constexpr LinearForm scaled(double factor) const
+    {
+        LinearForm result = *this;
+        for (auto& c : result.coefficients) {
+            c *= factor;
+        }
+        result.constant *= factor;
+        return result;
+    }
+};
+
+// Affine forms of expressions built from scalar quantities, constants,
+// sums, differences and products or quotients with a constant factor. Any
+// other node makes the expression nonlinear.
+template <typename Expression, typename SystemType, std::size_t inputSize>
+struct linear_form
+{
+    constexpr static LinearForm<inputSize> value{};
+};
+
+template <typename Tag, typename Unit_, StringLiteral symbol, typename SystemType, std::size_t inputSize>
+struct linear_form<Quantity<Tag, Unit_, symbol>, SystemType, inputSize>
+{
+    constexpr static auto value = []() {
+        LinearForm<inputSize> result{true};
+        result.coefficients[get_offset<Quantity<Tag, Unit_, symbol>, SystemType>()] = 1.0;
+        return result;
+    }();
+};
+
+template <typename value_, typename Unit_, typename SystemType, std::size_t inputSize>
+struct linear_form<ScalarValue<value_, Unit_>, SystemType, inputSize>
+{
+    constexpr static LinearForm<inputSize> value{true, {}, ScalarValue<value_, Unit_>::value};
+};
+
+template <typename Lhs, typename Rhs, typename SystemType, std::size_t inputSize>
+struct linear_form<Add<Lhs, Rhs>, SystemType, inputSize>
+{
+    constexpr static auto value = []() {
+        constexpr auto lhs = linear_form<Lhs, SystemType, inputSize>::value;
+        constexpr auto rhs = linear_form<Rhs, SystemType, inputSize>::value;
+        LinearForm<inputSize> result{lhs.linear && rhs.linear, {}, lhs.constant + rhs.constant};
+        for (std::size_t i = 0; i < inputSize; ++i) {
+            result.coefficients[i] = lhs.coefficients[i] + rhs.coefficients[i];
+        }
+        return result;
+    }();
+};
+
+template <typename Lhs, typename Rhs, typename SystemType, std::size_t inputSize>
+struct linear_form<Substract<Lhs, Rhs>, SystemType, inputSize>
+{
+    constexpr static auto value = []() {
+        constexpr auto lhs = linear_form<Lhs, SystemType, inputSize>::value;
+        constexpr auto rhs = linear_form<Rhs, SystemType, inputSize>::value;
+        LinearForm<inputSize> result{lhs.linear && rhs.linear, {}, lhs.constant - rhs.constant};
+        for (std::size_t i = 0; i < inputSize; ++i) {
+            result.coefficients[i] = lhs.coefficients[i] - rhs.coefficients[i];
+        }
+        return result;
+    }();
+};
+
+template <typename Lhs, typename Rhs, typename SystemType, std::size_t inputSize>
+struct linear_form<Multiply<Lhs, Rhs>, SystemType, inputSize>
+{
+    constexpr static auto value = []() {
+        constexpr auto lhs = linear_form<Lhs, SystemType, inputSize>::value;
+        constexpr auto rhs = linear_form<Rhs, SystemType, inputSize>::value;
+        if constexpr (lhs.is_constant() && rhs.linear) {
+            return rhs.scaled(lhs.constant);
+        } else if constexpr (rhs.is_constant() && lhs.linear) {
+            return lhs.scaled(rhs.constant);
+        } else {
+            return LinearForm<inputSize>{};
+        }
+    }();
+};
+
+template <typename Lhs, typename Rhs, typename Addend, typename SystemType, std::size_t inputSize>
+struct linear_form<FusedMultiplyAdd<Lhs, Rhs, Addend>, SystemType, inputSize>
+{
+    constexpr static auto value = linear_form<Add<Multiply<Lhs, Rhs>, Addend>, SystemType, inputSize>::value;
+};
+
+template <typename Lhs, typename Rhs, typename SystemType, std::size_t inputSize>
+struct linear_form<Divide<Lhs, Rhs>, SystemType, inputSize>
+{
+    constexpr static auto value = []() {
+        constexpr auto lhs = linear_form<Lhs, SystemType, inputSize>::value;
+        constexpr auto rhs = linear_form<Rhs, SystemType, inputSize>::value;
+        if constexpr (rhs.is_constant() && rhs.constant != 0.0 && lhs.linear) {
+            return lhs.scaled(1.0 / rhs.constant);
+        } else {
+            return LinearForm<inputSize>{};
+        }
+    }();
+};
+
+template <std::size_t n>
+using square_matrix_t = std::array<std::array<double, n>, n>;
+
+template <std::size_t n>
+constexpr square_matrix_t<n> matrix_product(const square_matrix_t<n>& lhs, const square_matrix_t<n>& rhs)
+{
+    square_matrix_t<n> result{};
+    for (std::size_t row = 0; row < n; ++row) {
+        for (std::size_t k = 0; k < n; ++k) {
+            for (std::size_t col = 0; col < n; ++col) {
+                result[row][col] += lhs[row][k] * rhs[k][col];
+            }
+        }
+    }
+    return result;
+}
+
+// e^M by scaling and squaring of a truncated Taylor series
+template <std::size_t n>
+constexpr square_matrix_t<n> matrix_exponential(square_matrix_t<n> m)
+{
+    double norm = 0.0;
+    for (const auto& row : m) {
+        double rowSum = 0.0;
+        for (const auto value : row) {
+            rowSum += value < 0.0 ? -value : value;
+        }
+        norm = std::max(norm, rowSum);
+    }
+    std::size_t squarings = 0;
+    double scale = 1.0;
+    for (; norm * scale > 0.5; ++squarings) {
+        scale /= 2.0;
+    }
+    for (auto& row : m) {
+        for (auto& value : row) {
+            value *= scale;
+        }
+    }
+    // ||m|| <= 1/2, so 20 terms are exact to rounding
+    square_matrix_t<n> result{};
+    square_matrix_t<n> term{};
+    for (std::size_t i = 0; i < n; ++i) {
+        result[i][i] = 1.0;
+        term[i][i] = 1.0;
+    }
+    for (std::size_t k = 1; k <= 20; ++k) {
+        term = matrix_product(term, m);
+        for (std::size_t row = 0; row < n; ++row) {
+            for (std::size_t col = 0; col < n; ++col) {
+                term[row][col] /= static_cast<double>(k);
+                result[row][col] += term[row][col];
+            }
+        }
+    }
+    for (std::size_t i = 0; i < squarings; ++i) {
+        result = matrix_product(result, result);
+    }
+    return result;
+}
+
+} // namespace detail
+
+// The equations of System whose right-hand side is affine in the states and
+// controls with constant coefficients and reads only states of such
+// equations: x_L' = A x_L + B u + c. The remaining equations may read the
+// linear states.
+template <typename System>
+struct linear_split
+{
+    using AllStates = typename System::AllStates;
+    using Derivatives = std::remove_cvref_t<decltype(System::derivativeFunctions)>;
+    constexpr static std::size_t inputSize = System::stateSize + System::controlSize;
+    constexpr static std::size_t equationCount = std::tuple_size_v<Derivatives>;
+
+    constexpr static auto forms = []<std::size_t... idx>(std::index_sequence<idx...> /*equations*/) {
+        return std::array<detail::LinearForm<inputSize>, equationCount>{
+            (std::tuple_element_t<idx, Derivatives>::extent == 1
+                 ? detail::linear_form<typename std::tuple_element_t<idx, Derivatives>::Expression, AllStates, inputSize>::value
+                 : detail::LinearForm<inputSize>{})...};
+    }(std::make_index_sequence<equationCount>{});
+
+    constexpr static auto stateSlot = []<std::size_t... idx>(std::index_sequence<idx...> /*equations*/) {
+        return std::array<std::size_t, equationCount>{
+            get_offset<typename std::tuple_element_t<idx, Derivatives>::Operand, AllStates>()...};
+    }(std::make_index_sequence<equationCount>{});
+
+    // linear equations, dropping those that read a state of a nonlinear one
+    // until none does
+    constexpr static auto isLinear = []() {
+        std::array<bool, equationCount> result{};
+        std::array<bool, System::stateSize> linearState{};
+        for (std::size_t eq = 0; eq < equationCount; ++eq) {
+            result[eq] = forms[eq].linear;
+        }
+        for (bool changed = true; changed;) {
+            changed = false;
+            linearState.fill(false);
+            for (std::size_t eq = 0; eq < equationCount; ++eq) {
+                linearState[stateSlot[eq]] = result[eq];
+            }
+            for (std::size_t eq = 0; eq < equationCount; ++eq) {
+                for (std::size_t slot = 0; slot < System::stateSize && result[eq]; ++slot) {
+                    if (forms[eq].coefficients[slot] != 0.0 && !linearState[slot]) {
+                        result[eq] = false;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        return result;
+    }();
+
+    constexpr static std::size_t linearCount = static_cast<std::size_t>(std::ranges::count(isLinear, true));
+
+    template <bool linear, std::size_t count>
+    constexpr static auto select()
+    {
+        std::array<std::size_t, count> result{};
+        std::size_t next = 0;
+        for (std::size_t eq = 0; eq < equationCount; ++eq) {
+            if (isLinear[eq] == linear) {
+                result[next++] = eq;
+            }
+        }
+        return result;
+    }
+
+    constexpr static auto linearEquations = select<true, linearCount>();
+    constexpr static auto otherEquations = select<false, equationCount - linearCount>();
+
+    // A, in the order of linearEquations
+    constexpr static auto stateMatrix = []() {
+        detail::square_matrix_t<linearCount> result{};
+        for (std::size_t row = 0; row < linearCount; ++row) {
+            for (std::size_t col = 0; col < linearCount; ++col) {
+                result[row][col] = forms[linearEquations[row]].coefficients[stateSlot[linearEquations[col]]];
+            }
+        }
+        return result;
+    }();
+
+    // B
+    constexpr static auto inputMatrix = []() {
+        std::array<std::array<double, System::controlSize>, linearCount> result{};
+        for (std::size_t row = 0; row < linearCount; ++row) {
+            for (std::size_t col = 0; col < System::controlSize; ++col) {
+                result[row][col] = forms[linearEquations[row]].coefficients[System::stateSize + col];
+            }
+        }
+        return result;
+    }();
+
+    // c
+    constexpr static auto offset = []() {
+        std::array<double, linearCount> result{};
+        for (std::size_t row = 0; row < linearCount; ++row) {
+            result[row] = forms[linearEquations[row]].constant;
+        }
+        return result;
+    }();
+};
+
+// Exponential integrator for systems with a linear_split. The linear states
+// advance exactly over a step with controls held, x_L(t0 + tau) =
+// Phi(tau) x_L(t0) + Gamma(tau) (B u + c), where Phi = e^(A tau) and Gamma is
+// its integral, both precomputed for tau = dt/2 and dt on construction. The
+// other equations go through Stepper, which reads the linear states at the
+// time of every stage through its ControlSource overload.
+template <typename System, typename Stepper = RungeKutta4>
+class ExponentialIntegrator
+{
+public:
+    using Split = linear_split<System>;
+    using Rest = detail::EquationGroup<System, detail::index_sequence_of<Split::otherEquations>>;
+    constexpr static std::size_t linearCount = Split::linearCount;
+    constexpr static std::size_t inputSize = System::stateSize + System::controlSize;
+
+    constexpr explicit ExponentialIntegrator(double dt) : dt_(dt), half_(propagator(dt / 2.0)), full_(propagator(dt)) {}
+
+    constexpr void step(std::span<double, System::stateSize> states, std::span<const double, System::controlSize> controls)
+    {
+        std::ranges::copy(states, start_.begin());
+        std::ranges::copy(controls, start_.begin() + System::stateSize);
+        for (std::size_t row = 0; row < linearCount; ++row) {
+            drive_[row] = Split::offset[row];
+            for (std::size_t col = 0; col < System::controlSize; ++col) {
+                drive_[row] += Split::inputMatrix[row][col] * controls[col];
+            }
+        }
+        auto end = start_;
+        if constexpr (Rest::stateSize > 0) {
+            std::array<double, Rest::stateSize> rest{};
+            Rest::gather_states(start_, rest);
+            Stepper::template step<Rest>(std::span<double, Rest::stateSize>(rest), *this, 0.0, dt_);
+            Rest::scatter(rest, end);
+        }
+        propagate(full_, end);
+        std::copy_n(end.begin(), System::stateSize, states.begin());
+    }
+
+    // the slots the Rest stepper does not advance at tau into the step,
+    // with the linear states on their exact trajectory
+    constexpr void sample(double tau, std::span<double, Rest::controlSize> restControls)
+    {
+        auto at = start_;
+        if (tau == dt_) {
+            propagate(full_, at);
+        } else if (tau == dt_ / 2.0) {
+            propagate(half_, at);
+        } else if (tau != 0.0) {
+            propagate(propagator(tau), at);
+        }
+        Rest::gather_controls(at, restControls);
+    }
+
+private:
+    struct Propagator
+    {
+        detail::square_matrix_t<linearCount> phi{};
+        detail::square_matrix_t<linearCount> gamma{};
+    };
+
+    // Phi and Gamma from e^[[A tau, I tau], [0, 0]] = [[Phi, Gamma], [0, I]]
+    constexpr static Propagator propagator(double tau)
+    {
+        detail::square_matrix_t<2 * linearCount> augmented{};
+        for (std::size_t row = 0; row < linearCount; ++row) {
+            for (std::size_t col = 0; col < linearCount; ++col) {
+                augmented[row][col] = Split::stateMatrix[row][col] * tau;
+            }
+            augmented[row][linearCount + row] = tau;
+        }
+        const auto exponential = detail::matrix_exponential(augmented);
+        Propagator result{};
+        for (std::size_t row = 0; row < linearCount; ++row) {
+            for (std::size_t col = 0; col < linearCount; ++col) {
+                result.phi[row][col] = exponential[row][col];
+                result.gamma[row][col] = exponential[row][linearCount + col];
+            }
+        }
+        return result;
+    }
+
+    // linear states of `at` from those at the start of the step
+    constexpr void propagate(const Propagator& p, std::span<double, inputSize> at) const
+    {
+        for (std::size_t row = 0; row < linearCount; ++row) {
+            double value = 0.0;
+            for (std::size_t col = 0; col < linearCount; ++col) {
+                value += p.phi[row][col] * start_[Split::stateSlot[Split::linearEquations[col]]] + p.gamma[row][col] * drive_[col];
+            }
+            at[Split::stateSlot[Split::linearEquations[row]]] = value;
+        }
+    }
+
+    double dt_;
+    Propagator half_;
+    Propagator full_;
+    std::array<double, inputSize> start_{};
+    std::array<double, linearCount> drive_{};
+};
+
+} // namespace codys
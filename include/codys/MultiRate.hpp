@@ -0,0 +1,204 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Integrator.hpp>
+#include <codys/StateSpaceSystem.hpp>
+#include <codys/tuple_utilities.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+namespace detail
+{
+
+// Splits the equations of System into those defining a state of Subsystem
+// (fast) and all others (slow).
+template <typename System, typename Subsystem>
+struct rate_groups
+{
+    using Derivatives = std::remove_cvref_t<decltype(System::derivativeFunctions)>;
+    constexpr static std::size_t equationCount = std::tuple_size_v<Derivatives>;
+
+    constexpr static auto isFast = []<std::size_t... idx>(std::index_sequence<idx...> /*equations*/) {
+        return std::array<bool, equationCount>{
+            Contains<typename std::tuple_element_t<idx, Derivatives>::Operand, states_defined_by_t<Subsystem>>::value...};
+    }(std::make_index_sequence<equationCount>{});
+
+    constexpr static std::size_t fastCount = static_cast<std::size_t>(std::ranges::count(isFast, true));
+
+    template <bool fast, std::size_t count>
+    constexpr static auto select()
+    {
+        std::array<std::size_t, count> result{};
+        std::size_t next = 0;
+        for (std::size_t eq = 0; eq < equationCount; ++eq) {
+            if (isFast[eq] == fast) {
+                result[next++] = eq;
+            }
+        }
+        return result;
+    }
+
+    constexpr static auto fastEquations = select<true, fastCount>();
+    constexpr static auto slowEquations = select<false, equationCount - fastCount>();
+};
+
+// The equations of System in Equations as a system of their own: the states
+// are the slots those equations define, every other slot of System (other
+// states and the controls) is a control held by the caller.
+template <typename System, typename Equations>
+struct EquationGroup;
+
+template <typename System, std::size_t... equationIdx>
+struct EquationGroup<System, std::index_sequence<equationIdx...>>
+{
+    using Derivatives = std::remove_cvref_t<decltype(System::derivativeFunctions)>;
+    constexpr static std::size_t inputSize = System::stateSize + System::controlSize;
+    constexpr static std::size_t stateSize = (std::size_t{0} + ... + std::tuple_element_t<equationIdx, Derivatives>::extent);
+    constexpr static std::size_t controlSize = inputSize - stateSize;
+
+    // slot in System of every group state, then of every group control
+    constexpr static auto slots = []() {
+        std::array<std::size_t, inputSize> result{};
+        std::array<bool, inputSize> isState{};
+        std::size_t next = 0;
+        ([&]<typename DerivativeType>() {
+            constexpr auto offset = get_offset<typename DerivativeType::Operand, typename System::AllStates>();
+            for (std::size_t element = 0; element < DerivativeType::extent; ++element) {
+                isState[offset + element] = true;
+                result[next++] = offset + element;
+            }
+        }.template operator()<std::tuple_element_t<equationIdx, Derivatives>>(), ...);
+        for (std::size_t slot = 0; slot < inputSize; ++slot) {
+            if (!isState[slot]) {
+                result[next++] = slot;
+            }
+        }
+        return result;
+    }();
+
+    constexpr static void evaluate(
+        std::span<const double, stateSize + controlSize> statesIn,
+        std::span<double, stateSize> derivativesOut)
+    {
+        std::array<double, inputSize> full{};
+        for (std::size_t i = 0; i < inputSize; ++i) {
+            full[slots[i]] = statesIn[i];
+        }
+        std::array<double, System::stateSize> derivatives{};
+        System::evaluate_equations(std::index_sequence<equationIdx...>{}, full, derivatives);
+        for (std::size_t i = 0; i < stateSize; ++i) {
+            derivativesOut[i] = derivatives[slots[i]];
+        }
+    }
+
+    constexpr static void gather_states(std::span<const double, inputSize> full, std::span<double, stateSize> states)
+    {
+        for (std::size_t i = 0; i < stateSize; ++i) {
+            states[i] = full[slots[i]];
+        }
+    }
+
+    constexpr static void gather_controls(std::span<const double, inputSize> full, std::span<double, controlSize> controls)
+    {
+        for (std::size_t i = 0; i < controlSize; ++i) {
+            controls[i] = full[slots[stateSize + i]];
+        }
+    }
+
+    constexpr static void scatter(std::span<const double, stateSize> states, std::span<double, inputSize> full)
+    {
+        for (std::size_t i = 0; i < stateSize; ++i) {
+            full[slots[i]] = states[i];
+        }
+    }
+};
+
+} // namespace detail
+
+// what the slow group sees of the fast states during its step
+enum class FastCoupling
+{
+    Sample,  // their values at the start of the step
+    Average, // their mean over the fast sub-steps; costs a second slow step
+};
+
+// Multi-rate one-step method: the equations defining states of FastSubsystem
+// (e.g. one of the subsystems passed to combine<...>) take `ratio` sub-steps
+// per step, all other equations one step. The slow group steps first; the
+// fast sub-steps then see the slow states linearly interpolated to their
+// midpoints. Satisfies FixedStepper, so it plugs into RealTimeRunner.
+template <typename FastSubsystem, std::size_t ratio, typename Stepper = RungeKutta4,
+          FastCoupling coupling = FastCoupling::Sample>
+struct MultiRate
+{
+    static_assert(ratio >= 1);
+
+    template <typename System>
+    constexpr static void step(
+        std::span<double, System::stateSize> states,
+        std::span<const double, System::controlSize> controls,
+        double dt)
+    {
+        using Groups = detail::rate_groups<System, FastSubsystem>;
+        using Fast = detail::EquationGroup<System, detail::index_sequence_of<Groups::fastEquations>>;
+        using Slow = detail::EquationGroup<System, detail::index_sequence_of<Groups::slowEquations>>;
+        constexpr auto inputSize = System::stateSize + System::controlSize;
+
+        std::array<double, inputSize> start{};
+        std::ranges::copy(states, start.begin());
+        std::ranges::copy(controls, start.begin() + System::stateSize);
+
+        const auto stepSlow = [dt](std::span<const double, inputSize> in, std::span<double, inputSize> out) {
+            std::array<double, Slow::stateSize> slowStates{};
+            std::array<double, Slow::controlSize> slowControls{};
+            Slow::gather_states(in, slowStates);
+            Slow::gather_controls(in, slowControls);
+            Stepper::template step<Slow>(slowStates, slowControls, dt);
+            Slow::scatter(slowStates, out);
+        };
+
+        auto end = start;
+        stepSlow(start, end);
+
+        std::array<double, Fast::stateSize> fastStates{};
+        std::array<double, Fast::controlSize> fastControls{};
+        std::array<double, Fast::stateSize> fastMean{};
+        Fast::gather_states(start, fastStates);
+        auto midpoint = start;
+        for (std::size_t sub = 0; sub < ratio; ++sub) {
+            const double weight = (static_cast<double>(sub) + 0.5) / static_cast<double>(ratio);
+            for (std::size_t i = 0; i < Slow::stateSize; ++i) {
+                const auto slot = Slow::slots[i];
+                midpoint[slot] = start[slot] + weight * (end[slot] - start[slot]);
+            }
+            Fast::gather_controls(midpoint, fastControls);
+            // trapezoidal mean over the sub-step
+            for (std::size_t i = 0; i < Fast::stateSize; ++i) {
+                fastMean[i] += fastStates[i] / (2.0 * static_cast<double>(ratio));
+            }
+            Stepper::template step<Fast>(fastStates, fastControls, dt / static_cast<double>(ratio));
+            for (std::size_t i = 0; i < Fast::stateSize; ++i) {
+                fastMean[i] += fastStates[i] / (2.0 * static_cast<double>(ratio));
+            }
+        }
+
+        if constexpr (coupling == FastCoupling::Average) {
+            auto averaged = start;
+            Fast::scatter(fastMean, averaged);
+            stepSlow(averaged, end);
+        }
+        Fast::scatter(fastStates, end);
+        std::copy_n(end.begin(), System::stateSize, states.begin());
+    }
+};
+
+} // namespace codys
@@ -9,8 +9,12 @@
 #include <fmt/format.h>
 #include <fmt/compile.h>
 
+#include <bit>
+#include <cmath>
+#include <cstdint>
 #include <span>
 #include <tuple>
+#include <type_traits>
 
 namespace codys
 {
@@ -28,18 +32,19 @@ constexpr std::string_view toView(const std::array<char, N>& arr)
 }
 
 template <SystemExpression Lhs, SystemExpression Rhs> requires
-    std::is_same_v<typename Lhs::Unit, typename Rhs::Unit>
+    std::is_same_v<typename Lhs::Unit, typename Rhs::Unit> && compatible_extents<Lhs, Rhs>
 struct Add
 {
     using depends_on =
     to_unique_tuple_t<tuple_cat_t<typename Lhs::depends_on, typename Rhs::depends_on>>;
     using Unit = typename Rhs::Unit;
+    constexpr static std::size_t extent = common_extent_v<Lhs, Rhs>;
 
     template <class SystemType, std::size_t N>
-    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr)
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
     {
-        return Lhs::template evaluate<SystemType>(arr) +
-               Rhs::template evaluate<SystemType>(arr);
+        return Lhs::template evaluate<SystemType>(arr, element) +
+               Rhs::template evaluate<SystemType>(arr, element);
     }
 
     template <class SystemType>
@@ -67,18 +72,19 @@ constexpr auto operator+(Lhs /*lhs*/,
 }
 
 template <class Lhs, class Rhs> requires std::is_same_v<
-    typename Lhs::Unit, typename Rhs::Unit>
+    typename Lhs::Unit, typename Rhs::Unit> && compatible_extents<Lhs, Rhs>
 struct Substract
 {
     using depends_on =
     to_unique_tuple_t<tuple_cat_t<typename Lhs::depends_on, typename Rhs::depends_on>>;
     using Unit = typename Rhs::Unit;
+    constexpr static std::size_t extent = common_extent_v<Lhs, Rhs>;
 
     template <class SystemType, std::size_t N>
-    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr)
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
     {
-        return Lhs::template evaluate<SystemType>(arr) -
-               Rhs::template evaluate<SystemType>(arr);
+        return Lhs::template evaluate<SystemType>(arr, element) -
+               Rhs::template evaluate<SystemType>(arr, element);
     }
 
     template <class SystemType>
@@ -101,19 +107,20 @@ constexpr auto operator-(Lhs /*lhs*/,
     return Substract<Lhs, Rhs>{};
 }
 
-template <class Lhs, class Rhs>
+template <class Lhs, class Rhs> requires compatible_extents<Lhs, Rhs>
 struct Multiply
 {
     using depends_on =
     to_unique_tuple_t<tuple_cat_t<typename Lhs::depends_on, typename Rhs::depends_on>>;
     using Unit = decltype(std::declval<typename Lhs::Unit>() * std::declval<
                               typename Rhs::Unit>());
+    constexpr static std::size_t extent = common_extent_v<Lhs, Rhs>;
 
     template <class SystemType, std::size_t N>
-    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr)
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
     {
-        return Lhs::template evaluate<SystemType>(arr) *
-               Rhs::template evaluate<SystemType>(arr);
+        return Lhs::template evaluate<SystemType>(arr, element) *
+               Rhs::template evaluate<SystemType>(arr, element);
     }
 
     template <class SystemType>
@@ -140,19 +147,20 @@ constexpr auto operator*(Lhs /*lhs*/,
     return Multiply<Lhs, Rhs>{};
 }
 
-template <class Lhs, class Rhs>
+template <class Lhs, class Rhs> requires compatible_extents<Lhs, Rhs>
 struct Divide
 {
     using depends_on =
     to_unique_tuple_t<tuple_cat_t<typename Lhs::depends_on, typename Rhs::depends_on>>;
     using Unit = decltype(std::declval<typename Lhs::Unit>() / std::declval<
                               typename Rhs::Unit>());
+    constexpr static std::size_t extent = common_extent_v<Lhs, Rhs>;
 
     template <class SystemType, std::size_t N>
-    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr)
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
     {
-        return Lhs::template evaluate<SystemType>(arr) /
-               Rhs::template evaluate<SystemType>(arr);
+        return Lhs::template evaluate<SystemType>(arr, element) /
+               Rhs::template evaluate<SystemType>(arr, element);
     }
 
     template <class SystemType>
@@ -179,16 +187,77 @@ constexpr auto operator/(Lhs /*lhs*/,
     return Divide<Lhs, Rhs>{};
 }
 
+namespace detail
+{
+
+// std::fma is not constexpr before C++26, so constant evaluation rounds the
+// product and the sum separately and may differ from the runtime result in
+// the last bit.
+constexpr double fused_multiply_add(double lhs, double rhs, double addend)
+{
+    if (std::is_constant_evaluated()) {
+        return lhs * rhs + addend;
+    }
+    return std::fma(lhs, rhs, addend);
+}
+
+} // namespace detail
+
+// lhs * rhs + addend, rounded once at runtime (see
+// detail::fused_multiply_add for constant evaluation). Written like the unfused form, so the
+// formatted system does not depend on whether it was contracted.
+template <SystemExpression Lhs, SystemExpression Rhs, SystemExpression Addend> requires
+    std::is_same_v<typename Multiply<Lhs, Rhs>::Unit, typename Addend::Unit> && compatible_extents<Lhs, Rhs, Addend>
+struct FusedMultiplyAdd
+{
+    using depends_on = to_unique_tuple_t<tuple_cat_t<
+        typename Lhs::depends_on, typename Rhs::depends_on, typename Addend::depends_on>>;
+    using Unit = typename Addend::Unit;
+    constexpr static std::size_t extent = common_extent_v<Lhs, Rhs, Addend>;
+
+    template <class SystemType, std::size_t N>
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
+    {
+        return detail::fused_multiply_add(Lhs::template evaluate<SystemType>(arr, element),
+                                          Rhs::template evaluate<SystemType>(arr, element),
+                                          Addend::template evaluate<SystemType>(arr, element));
+    }
+
+    template <class SystemType>
+    static constexpr auto format_in()
+    {
+        constexpr auto fmt_string_lhs = Lhs::template format_in<SystemType>();
+        constexpr auto fmt_string_rhs = Rhs::template format_in<SystemType>();
+        constexpr auto fmt_string_addend = Addend::template format_in<SystemType>();
+        constexpr auto compiled = FMT_COMPILE("{} * {} + {}");
+        constexpr auto size = fmt::formatted_size(
+            compiled, toView(fmt_string_lhs), toView(fmt_string_rhs), toView(fmt_string_addend)
+            );
+        auto result = std::array<char, size>();
+        fmt::format_to(result.data(), compiled, toView(fmt_string_lhs),
+                       toView(fmt_string_rhs), toView(fmt_string_addend)
+            );
+        return result;
+    }
+};
+
+template <SystemExpression Lhs, SystemExpression Rhs, SystemExpression Addend>
+constexpr auto fma(Lhs /*lhs*/, Rhs /*rhs*/, Addend /*addend*/)
+{
+    return FusedMultiplyAdd<Lhs, Rhs, Addend>{};
+}
+
 template <class Lhs>
 struct Sinus
 {
     using depends_on = typename Lhs::depends_on;
     using Unit = decltype(sin(std::declval<typename Lhs::Unit>()));
+    constexpr static std::size_t extent = extent_v<Lhs>;
 
     template <class SystemType, std::size_t N>
-    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr)
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
     {
-        return std::sin(Lhs::template evaluate<SystemType>(arr));
+        return std::sin(Lhs::template evaluate<SystemType>(arr, element));
     }
 
     template <class SystemType>
@@ -216,11 +285,12 @@ struct Cosinus
 {
     using depends_on = typename Lhs::depends_on;
     using Unit = decltype(cos(std::declval<typename Lhs::Unit>()));
+    constexpr static std::size_t extent = extent_v<Lhs>;
 
     template <class SystemType, std::size_t N>
-    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr)
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
     {
-        return std::cos(Lhs::template evaluate<SystemType>(arr));
+        return std::cos(Lhs::template evaluate<SystemType>(arr, element));
     }
 
     template <class SystemType>
@@ -243,4 +313,233 @@ constexpr auto cos(Lhs /*lhs*/)
     return Cosinus<Lhs>{};
 }
 
-} // namespace codys
\ No newline at end of file
+// reduction over all elements of an array expression, e.g. the mean field of a fleet
+template <class Lhs>
+struct Sum
+{
+    using depends_on = typename Lhs::depends_on;
+    using Unit = typename Lhs::Unit;
+    constexpr static std::size_t extent = 1;
+
+    template <class SystemType, std::size_t N>
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t /*element*/ = 0)
+    {
+        double result = 0.0;
+        for (std::size_t element = 0; element < extent_v<Lhs>; ++element) {
+            result += Lhs::template evaluate<SystemType>(arr, element);
+        }
+        return result;
+    }
+
+    template <class SystemType>
+    static constexpr auto format_in()
+    {
+        constexpr auto fmt_string_lhs = Lhs::template format_in<SystemType>();
+        constexpr auto compiled = FMT_COMPILE("\\sum({})");
+        constexpr auto size = fmt::formatted_size(
+            compiled, toView(fmt_string_lhs)
+            );
+        auto result = std::array<char, size>();
+        fmt::format_to(result.data(), compiled, toView(fmt_string_lhs));
+        return result;
+    }
+};
+
+template <SystemExpression Lhs>
+constexpr auto sum(Lhs /*lhs*/)
+{
+    return Sum<Lhs>{};
+}
+
+namespace detail
+{
+
+// onTrue if condition, otherwise onFalse, as a bit mask instead of a jump
+constexpr double blend(bool condition, double onTrue, double onFalse)
+{
+    const auto mask = std::uint64_t{0} - static_cast<std::uint64_t>(condition);
+    return std::bit_cast<double>((std::bit_cast<std::uint64_t>(onTrue) & mask) |
+                                 (std::bit_cast<std::uint64_t>(onFalse) & ~mask));
+}
+
+} // namespace detail
+
+// Saturations and conditionals. All operands are evaluated and combined with
+// blend, so scalar code has no branches to mispredict and element-wise loops
+// over arrays vectorize to masked moves.
+template <SystemExpression Lhs, SystemExpression Rhs> requires
+    std::is_same_v<typename Lhs::Unit, typename Rhs::Unit> && compatible_extents<Lhs, Rhs>
+struct Min
+{
+    using depends_on =
+    to_unique_tuple_t<tuple_cat_t<typename Lhs::depends_on, typename Rhs::depends_on>>;
+    using Unit = typename Rhs::Unit;
+    constexpr static std::size_t extent = common_extent_v<Lhs, Rhs>;
+
+    template <class SystemType, std::size_t N>
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
+    {
+        const double lhs = Lhs::template evaluate<SystemType>(arr, element);
+        const double rhs = Rhs::template evaluate<SystemType>(arr, element);
+        return detail::blend(rhs < lhs, rhs, lhs);
+    }
+
+    template <class SystemType>
+    static constexpr auto format_in()
+    {
+        constexpr auto fmt_string_lhs = Lhs::template format_in<SystemType>();
+        constexpr auto fmt_string_rhs = Rhs::template format_in<SystemType>();
+        constexpr auto compiled = FMT_COMPILE("\\min({}, {})");
+        constexpr auto size = fmt::formatted_size(
+            compiled, toView(fmt_string_lhs), toView(fmt_string_rhs)
+            );
+        auto result = std::array<char, size>();
+        fmt::format_to(result.data(), compiled, toView(fmt_string_lhs),
+                       toView(fmt_string_rhs)
+            );
+        return result;
+    }
+};
+
+template <SystemExpression Lhs, SystemExpression Rhs>
+constexpr auto min(Lhs /*lhs*/, Rhs /*rhs*/)
+{
+    return Min<Lhs, Rhs>{};
+}
+
+template <SystemExpression Lhs, SystemExpression Rhs> requires
+    std::is_same_v<typename Lhs::Unit, typename Rhs::Unit> && compatible_extents<Lhs, Rhs>
+struct Max
+{
+    using depends_on =
+    to_unique_tuple_t<tuple_cat_t<typename Lhs::depends_on, typename Rhs::depends_on>>;
+    using Unit = typename Rhs::Unit;
+    constexpr static std::size_t extent = common_extent_v<Lhs, Rhs>;
+
+    template <class SystemType, std::size_t N>
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
+    {
+        const double lhs = Lhs::template evaluate<SystemType>(arr, element);
+        const double rhs = Rhs::template evaluate<SystemType>(arr, element);
+        return detail::blend(lhs < rhs, rhs, lhs);
+    }
+
+    template <class SystemType>
+    static constexpr auto format_in()
+    {
+        constexpr auto fmt_string_lhs = Lhs::template format_in<SystemType>();
+        constexpr auto fmt_string_rhs = Rhs::template format_in<SystemType>();
+        constexpr auto compiled = FMT_COMPILE("\\max({}, {})");
+        constexpr auto size = fmt::formatted_size(
+            compiled, toView(fmt_string_lhs), toView(fmt_string_rhs)
+            );
+        auto result = std::array<char, size>();
+        fmt::format_to(result.data(), compiled, toView(fmt_string_lhs),
+                       toView(fmt_string_rhs)
+            );
+        return result;
+    }
+};
+
+template <SystemExpression Lhs, SystemExpression Rhs>
+constexpr auto max(Lhs /*lhs*/, Rhs /*rhs*/)
+{
+    return Max<Lhs, Rhs>{};
+}
+
+template <SystemExpression Value, SystemExpression Lower, SystemExpression Upper>
+constexpr auto clamp(Value value, Lower lower, Upper upper)
+{
+    return min(max(value, lower), upper);
+}
+
+// 1 where lhs < rhs, otherwise 0; only meaningful as the condition of select
+template <SystemExpression Lhs, SystemExpression Rhs> requires
+    std::is_same_v<typename Lhs::Unit, typename Rhs::Unit> && compatible_extents<Lhs, Rhs>
+struct Less
+{
+    using depends_on =
+    to_unique_tuple_t<tuple_cat_t<typename Lhs::depends_on, typename Rhs::depends_on>>;
+    using Unit = bool;
+    constexpr static std::size_t extent = common_extent_v<Lhs, Rhs>;
+
+    template <class SystemType, std::size_t N>
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
+    {
+        return Lhs::template evaluate<SystemType>(arr, element) < Rhs::template evaluate<SystemType>(arr, element) ? 1.0 : 0.0;
+    }
+
+    template <class SystemType>
+    static constexpr auto format_in()
+    {
+        constexpr auto fmt_string_lhs = Lhs::template format_in<SystemType>();
+        constexpr auto fmt_string_rhs = Rhs::template format_in<SystemType>();
+        constexpr auto compiled = FMT_COMPILE("{} < {}");
+        constexpr auto size = fmt::formatted_size(
+            compiled, toView(fmt_string_lhs), toView(fmt_string_rhs)
+            );
+        auto result = std::array<char, size>();
+        fmt::format_to(result.data(), compiled, toView(fmt_string_lhs),
+                       toView(fmt_string_rhs)
+            );
+        return result;
+    }
+};
+
+template <SystemExpression Lhs, SystemExpression Rhs>
+constexpr auto less(Lhs /*lhs*/, Rhs /*rhs*/)
+{
+    return Less<Lhs, Rhs>{};
+}
+
+template <SystemExpression Lhs, SystemExpression Rhs>
+constexpr auto greater(Lhs /*lhs*/, Rhs /*rhs*/)
+{
+    return Less<Rhs, Lhs>{};
+}
+
+// OnTrue where Condition holds, otherwise OnFalse
+template <SystemExpression Condition, SystemExpression OnTrue, SystemExpression OnFalse> requires
+    std::is_same_v<typename Condition::Unit, bool> && std::is_same_v<typename OnTrue::Unit, typename OnFalse::Unit> &&
+    compatible_extents<Condition, OnTrue, OnFalse>
+struct Select
+{
+    using depends_on = to_unique_tuple_t<tuple_cat_t<
+        typename Condition::depends_on, typename OnTrue::depends_on, typename OnFalse::depends_on>>;
+    using Unit = typename OnTrue::Unit;
+    constexpr static std::size_t extent = common_extent_v<Condition, OnTrue, OnFalse>;
+
+    template <class SystemType, std::size_t N>
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
+    {
+        const double condition = Condition::template evaluate<SystemType>(arr, element);
+        const double onTrue = OnTrue::template evaluate<SystemType>(arr, element);
+        const double onFalse = OnFalse::template evaluate<SystemType>(arr, element);
+        return detail::blend(condition != 0.0, onTrue, onFalse);
+    }
+
+    template <class SystemType>
+    static constexpr auto format_in()
+    {
+        constexpr auto fmt_string_condition = Condition::template format_in<SystemType>();
+        constexpr auto fmt_string_true = OnTrue::template format_in<SystemType>();
+        constexpr auto fmt_string_false = OnFalse::template format_in<SystemType>();
+        constexpr auto compiled = FMT_COMPILE("({} ? {} : {})");
+        constexpr auto size = fmt::formatted_size(
+            compiled, toView(fmt_string_condition), toView(fmt_string_true), toView(fmt_string_false)
+            );
+        auto result = std::array<char, size>();
+        fmt::format_to(result.data(), compiled, toView(fmt_string_condition),
+                       toView(fmt_string_true), toView(fmt_string_false)
+            );
+        return result;
+    }
+};
+
+template <SystemExpression Condition, SystemExpression OnTrue, SystemExpression OnFalse>
+constexpr auto select(Condition /*condition*/, OnTrue /*onTrue*/, OnFalse /*onFalse*/)
+{
+    return Select<Condition, OnTrue, OnFalse>{};
+}
+
+} // namespace codys
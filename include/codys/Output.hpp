@@ -0,0 +1,265 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Derivative.hpp>
+#include <codys/Quantity.hpp>
+#include <codys/Schedule.hpp>
+#include <codys/Simplify.hpp>
+#include <codys/Table.hpp>
+#include <codys/tuple_utilities.hpp>
+
+#include <fmt/compile.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+// Leaf reading the time derivative of a state, for output equations only.
+// Outputs are evaluated on [states, controls, derivatives], the layout
+// format_values prints.
+template <PhysicalType Operand_>
+struct DotOf
+{
+    using Operand = Operand_;
+    using Unit = detail::derivative_in_time_t<typename Operand::Unit>;
+    using depends_on = std::tuple<DotOf>;
+    constexpr static std::size_t extent = extent_v<Operand>;
+
+    template <class SystemType, std::size_t N>
+    constexpr static double evaluate(std::span<const double, N> arr, std::size_t element = 0)
+    {
+        return arr[get_offset<DotOf, SystemType>() + element];
+    }
+
+    template <class SystemType>
+    constexpr static auto format_in()
+    {
+        constexpr auto index = get_idx<DotOf, SystemType>();
+        constexpr auto compiled = FMT_COMPILE("{{{}}}");
+        constexpr auto size = fmt::formatted_size(compiled, index);
+        auto result = std::array<char, size>();
+        fmt::format_to(result.data(), compiled, index);
+        return result;
+    }
+};
+
+// y = h(x, u, dot x), named by a quantity that is not part of the system
+template <PhysicalType Name_, typename Expression_>
+struct OutputEquation
+{
+    using Name = Name_;
+    using Expression = Expression_;
+    using Unit = typename Expression::Unit;
+    static_assert(std::is_same_v<typename Name::Unit, Unit>, "output expression must have the unit of the output");
+    static_assert(extent_v<Expression> == 1, "outputs are scalar, reduce arrays with sum");
+};
+
+template <PhysicalType Name, typename Expression>
+constexpr auto output(Expression /*expression*/)
+{
+    return OutputEquation<Name, Expression>{};
+}
+
+namespace detail
+{
+
+// DotOf each state, the states being the leading quantities of AllStates
+template <typename AllStates, typename States>
+struct derivatives_of;
+
+template <typename AllStates, std::size_t... idx>
+struct derivatives_of<AllStates, std::index_sequence<idx...>>
+{
+    using type = std::tuple<DotOf<std::tuple_element_t<idx, AllStates>>...>;
+};
+
+template <typename T>
+struct reads_derivatives : std::false_type
+{
+};
+
+template <typename Operand>
+struct reads_derivatives<DotOf<Operand>> : std::true_type
+{
+};
+
+template <typename... Dependency>
+struct reads_derivatives<std::tuple<Dependency...>> : std::disjunction<reads_derivatives<Dependency>...>
+{
+};
+
+// DotOf the state whose equation among Derivatives has the scheduled
+// expression Expression, or void
+template <typename Expression, typename Derivatives>
+struct derivative_reading;
+
+template <typename Expression, typename... Equation>
+struct derivative_reading<Expression, std::tuple<Equation...>>
+{
+    constexpr static std::array<bool, sizeof...(Equation)> matches{
+        std::is_same_v<schedule_t<Expression>, typename Equation::Expression>...};
+    constexpr static std::size_t idx = static_cast<std::size_t>(std::ranges::find(matches, true) - matches.begin());
+
+    template <std::size_t equationIdx>
+    struct read
+    {
+        using type = DotOf<typename std::tuple_element_t<equationIdx, std::tuple<Equation...>>::Operand>;
+    };
+
+    using type = typename std::conditional_t<(idx < sizeof...(Equation)), read<idx>, std::type_identity<void>>::type;
+};
+
+// Expression with every operation subtree that a derivative equation of
+// Derivatives evaluates replaced by a read of that derivative. Leaves are
+// kept, reading a derivative is no cheaper than reading a quantity.
+template <typename Expression, typename Derivatives>
+struct reuse_derivatives
+{
+    using type = Expression;
+};
+
+template <template <typename...> class Node, typename... Operands, typename Derivatives>
+struct reuse_derivatives<Node<Operands...>, Derivatives>
+{
+    using Reading = typename derivative_reading<Node<Operands...>, Derivatives>::type;
+    using type = std::conditional_t<std::is_void_v<Reading>,
+                                    Node<typename reuse_derivatives<Operands, Derivatives>::type...>,
+                                    Reading>;
+};
+
+template <typename value_, typename Unit_, typename Derivatives>
+struct reuse_derivatives<ScalarValue<value_, Unit_>, Derivatives>
+{
+    using type = ScalarValue<value_, Unit_>;
+};
+
+template <typename Operand, typename Tau, typename Derivatives>
+struct reuse_derivatives<Delayed<Operand, Tau>, Derivatives>
+{
+    using type = Delayed<Operand, Tau>;
+};
+
+template <typename Operand, typename Derivatives>
+struct reuse_derivatives<DotOf<Operand>, Derivatives>
+{
+    using type = DotOf<Operand>;
+};
+
+template <typename Table, typename... Arguments, typename Derivatives>
+struct reuse_derivatives<Lookup<Table, Arguments...>, Derivatives>
+{
+    using Reading = typename derivative_reading<Lookup<Table, Arguments...>, Derivatives>::type;
+    using type = std::conditional_t<std::is_void_v<Reading>,
+                                    Lookup<Table, typename reuse_derivatives<Arguments, Derivatives>::type...>,
+                                    Reading>;
+};
+
+} // namespace detail
+
+// Outputs declared by OutputSpec::make_outputs() (typically next to make_dot)
+// of System, evaluated lazily and cached until the next update. Once the
+// derivatives of the point are known, every subtree of an output that is the
+// right-hand side of a derivative equation is read from them instead of being
+// evaluated again; subtrees shared only with parts of a right-hand side are
+// not, System::evaluate keeps no intermediate results. The derivatives are
+// passed to update when the caller has them (e.g. from the last stage of a
+// step); an output reading DotOf evaluates them once per point otherwise.
+template <typename System, typename OutputSpec>
+class SystemOutputs
+{
+public:
+    using Outputs = std::remove_cvref_t<decltype(OutputSpec::make_outputs())>;
+    using Layout = tuple_cat_t<typename System::AllStates,
+                               typename detail::derivatives_of<typename System::AllStates,
+                                                               std::make_index_sequence<System::derivativeFunctionsSize>>::type>;
+    constexpr static std::size_t inputSize = System::stateSize + System::controlSize;
+    constexpr static std::size_t outputCount = std::tuple_size_v<Outputs>;
+
+    template <PhysicalType Name>
+    constexpr static std::size_t output_idx()
+    {
+        return []<std::size_t... idx>(std::index_sequence<idx...> /*outputs*/) {
+            constexpr std::array<bool, outputCount> matches{
+                std::is_same_v<Name, typename std::tuple_element_t<idx, Outputs>::Name>...};
+            return static_cast<std::size_t>(std::ranges::find(matches, true) - matches.begin());
+        }(std::make_index_sequence<outputCount>{});
+    }
+
+    // expression evaluated for an output once the derivatives are known
+    template <PhysicalType Name>
+    using shared_expression_t = evaluated_t<typename detail::reuse_derivatives<
+        simplify_t<typename std::tuple_element_t<output_idx<Name>(), Outputs>::Expression>,
+        std::remove_cvref_t<decltype(System::derivativeFunctions)>>::type>;
+
+    // a new point, e.g. after a step; drops all cached outputs
+    constexpr void update(std::span<const double, inputSize> statesIn)
+    {
+        std::ranges::copy(statesIn, values_.begin());
+        cached_.fill(false);
+        derivativesValid_ = false;
+    }
+
+    constexpr void update(std::span<const double, inputSize> statesIn, std::span<const double, System::stateSize> derivatives)
+    {
+        update(statesIn);
+        std::ranges::copy(derivatives, values_.begin() + inputSize);
+        derivativesValid_ = true;
+    }
+
+    template <PhysicalType Name>
+    constexpr double get()
+    {
+        constexpr auto idx = output_idx<Name>();
+        static_assert(idx < outputCount, "no output of this name");
+        if (!cached_[idx]) {
+            outputs_[idx] = compute<Name>();
+            cached_[idx] = true;
+        }
+        return outputs_[idx];
+    }
+
+    template <PhysicalType Name>
+    [[nodiscard]] constexpr bool is_cached() const
+    {
+        return cached_[output_idx<Name>()];
+    }
+
+private:
+    template <PhysicalType Name>
+    constexpr double compute()
+    {
+        using Expression = typename std::tuple_element_t<output_idx<Name>(), Outputs>::Expression;
+        const auto values = std::span<const double, inputSize + System::stateSize>(values_);
+        if constexpr (detail::reads_derivatives<typename Expression::depends_on>::value) {
+            ensure_derivatives();
+        }
+        if (derivativesValid_) {
+            return shared_expression_t<Name>::template evaluate<Layout>(values);
+        }
+        return evaluated_t<Expression>::template evaluate<Layout>(values);
+    }
+
+    constexpr void ensure_derivatives()
+    {
+        if (!derivativesValid_) {
+            System::evaluate(std::span<const double, inputSize>(values_.data(), inputSize),
+                             std::span<double, System::stateSize>(values_.data() + inputSize, System::stateSize));
+            derivativesValid_ = true;
+        }
+    }
+
+    std::array<double, inputSize + System::stateSize> values_{};
+    std::array<double, outputCount> outputs_{};
+    std::array<bool, outputCount> cached_{};
+    bool derivativesValid_{false};
+};
+
+} // namespace codys
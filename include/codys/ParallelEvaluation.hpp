@@ -0,0 +1,162 @@
+#pragma once
+
+#include <codys/Partition.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace codys
+{
+
+// Fixed set of workers executing one batch of indexed tasks at a time. The
+// calling thread takes part in the batch, so ThreadPool(0) runs everything
+// inline. run() neither allocates nor type-erases through std::function.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(std::size_t workerCount = std::max(std::thread::hardware_concurrency(), 1U) - 1)
+    {
+        workers_.reserve(workerCount);
+        for (std::size_t i = 0; i < workerCount; ++i) {
+            workers_.emplace_back([this](const std::stop_token& stop) { work(stop); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            const std::scoped_lock lock(mutex_);
+            for (auto& worker : workers_) {
+                worker.request_stop();
+            }
+        }
+        wakeup_.notify_all();
+    }
+
+    [[nodiscard]] std::size_t concurrency() const
+    {
+        return workers_.size() + 1;
+    }
+
+    template <typename Func>
+    void run(std::size_t taskCount, Func&& func)
+    {
+        {
+            std::unique_lock lock(mutex_);
+            // a worker may still be leaving the previous batch
+            done_.wait(lock, [this] { return active_ == 0; });
+            task_ = &func;
+            invoke_ = [](void* task, std::size_t idx) { (*static_cast<std::remove_reference_t<Func>*>(task))(idx); };
+            taskCount_ = taskCount;
+            nextTask_.store(0, std::memory_order_relaxed);
+            pending_.store(taskCount, std::memory_order_relaxed);
+            ++generation_;
+        }
+        wakeup_.notify_all();
+
+        drain();
+
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0 && active_ == 0; });
+    }
+
+private:
+    void drain()
+    {
+        for (auto idx = nextTask_.fetch_add(1, std::memory_order_relaxed); idx < taskCount_;
+             idx = nextTask_.fetch_add(1, std::memory_order_relaxed)) {
+            invoke_(task_, idx);
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                const std::scoped_lock lock(mutex_);
+                done_.notify_all();
+            }
+        }
+    }
+
+    void work(const std::stop_token& stop)
+    {
+        std::size_t seenGeneration = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex_);
+                wakeup_.wait(lock, [&] { return stop.stop_requested() || generation_ != seenGeneration; });
+                if (stop.stop_requested()) {
+                    return;
+                }
+                seenGeneration = generation_;
+                ++active_;
+            }
+            drain();
+            {
+                const std::scoped_lock lock(mutex_);
+                --active_;
+            }
+            done_.notify_all();
+        }
+    }
+
+    std::vector<std::jthread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable done_;
+    std::size_t generation_{0};
+    std::size_t active_{0};
+    void* task_{nullptr};
+    void (*invoke_)(void*, std::size_t){nullptr};
+    std::size_t taskCount_{0};
+    std::atomic<std::size_t> nextTask_{0};
+    std::atomic<std::size_t> pending_{0};
+};
+
+// whether evaluate_parallel dispatches System to the pool at all: it needs
+// more than one group and an estimated cost of at least threshold
+template <typename System, std::size_t threshold = parallel_evaluation_threshold,
+          std::size_t maxGroups = parallel_evaluation_groups>
+constexpr bool dispatches_parallel =
+    equation_partition_of<System, maxGroups>::groupCount >= 2 &&
+    equation_partition_of<System, maxGroups>::totalCost >= threshold;
+
+// below parallel_evaluation_threshold (CostModel.hpp) evaluate serially
+template <typename System, std::size_t threshold = parallel_evaluation_threshold,
+          std::size_t maxGroups = parallel_evaluation_groups>
+void evaluate_parallel(
+    ThreadPool& pool,
+    std::span<const double, System::stateSize + System::controlSize> statesIn,
+    std::span<double, System::stateSize> derivativesOut)
+{
+    using Partition = equation_partition_of<System, maxGroups>;
+
+    if constexpr (!dispatches_parallel<System, threshold, maxGroups>) {
+        System::evaluate(statesIn, derivativesOut);
+    } else {
+        using GroupFunction = void (*)(std::span<const double, System::stateSize + System::controlSize>,
+                                       std::span<double, System::stateSize>);
+        constexpr auto groupFunctions = []<std::size_t... group>(std::index_sequence<group...> /*groups*/) {
+            return std::array<GroupFunction, sizeof...(group)>{&evaluate_group<System, group, maxGroups>...};
+        }(std::make_index_sequence<Partition::groupCount>{});
+
+        if (pool.concurrency() < 2) {
+            System::evaluate(statesIn, derivativesOut);
+            return;
+        }
+
+        pool.run(Partition::groupCount, [statesIn, derivativesOut, &groupFunctions](std::size_t task) {
+            groupFunctions[Partition::dispatchOrder[task]](statesIn, derivativesOut);
+        });
+    }
+}
+
+} // namespace codys
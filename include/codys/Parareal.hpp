@@ -0,0 +1,113 @@
+#pragma once
+
+#include <codys/Integrator.hpp>
+#include <codys/ParallelEvaluation.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace codys
+{
+
+struct PararealOptions
+{
+    std::size_t slices{8};
+    std::size_t coarseSteps{1};   // per slice
+    std::size_t fineSteps{1000};  // per slice
+    double tolerance{1e-10};      // on the largest correction, relative where states exceed one
+    std::size_t maxIterations{0}; // 0: up to slices, after which the result equals the serial fine solution
+};
+
+struct PararealReport
+{
+    std::size_t iterations{0};
+    double correction{0.0}; // of the last iteration
+};
+
+namespace detail
+{
+
+template <typename System, typename Stepper>
+void propagate(std::span<double, System::stateSize> states, std::span<const double, System::controlSize> controls,
+               double dt, std::size_t steps)
+{
+    for (std::size_t step = 0; step < steps; ++step) {
+        Stepper::template step<System>(states, controls, dt);
+    }
+}
+
+} // namespace detail
+
+// Parareal (Lions, Maday and Turinici 2001) from t0 to tEnd, split into
+// equal time slices. A serial sweep of the cheap Coarse stepper predicts the
+// state at the start of every slice; each iteration then runs the Fine
+// stepper over all unconverged slices at once on the pool and corrects the
+// predictions with a new coarse sweep, U[n+1] = G(U[n]) + F(U_old[n]) -
+// G(U_old[n]). After k iterations the first k slices equal the serial fine
+// solution. Stops once the largest correction is below the tolerance.
+template <typename System, FixedStepper<System> Coarse = Heun, FixedStepper<System> Fine = RungeKutta4>
+PararealReport parareal(
+    ThreadPool& pool,
+    std::span<double, System::stateSize> states,
+    std::span<const double, System::controlSize> controls,
+    double t0, double tEnd,
+    const PararealOptions& options)
+{
+    if (options.slices == 0 || options.coarseSteps == 0 || options.fineSteps == 0) {
+        throw std::invalid_argument("parareal needs at least one slice and one step per slice");
+    }
+    using Point = state_vector_t<System>;
+    const auto slices = options.slices;
+    const double sliceLength = (tEnd - t0) / static_cast<double>(slices);
+    const double coarseDt = sliceLength / static_cast<double>(options.coarseSteps);
+    const double fineDt = sliceLength / static_cast<double>(options.fineSteps);
+    const auto maxIterations = options.maxIterations == 0 ? slices : std::min(options.maxIterations, slices);
+
+    const auto coarse = [&](Point point) {
+        detail::propagate<System, Coarse>(point, controls, coarseDt, options.coarseSteps);
+        return point;
+    };
+
+    // start of every slice, and the coarse prediction from the previous one
+    std::vector<Point> start(slices + 1);
+    std::vector<Point> predicted(slices);
+    std::vector<Point> fine(slices);
+    std::ranges::copy(states, start[0].begin());
+    for (std::size_t n = 0; n < slices; ++n) {
+        predicted[n] = coarse(start[n]);
+        start[n + 1] = predicted[n];
+    }
+
+    PararealReport report{};
+    for (std::size_t first = 0; first < maxIterations; ++first) {
+        pool.run(slices - first, [&](std::size_t idx) {
+            const auto n = first + idx;
+            fine[n] = start[n];
+            detail::propagate<System, Fine>(fine[n], controls, fineDt, options.fineSteps);
+        });
+
+        report.correction = 0.0;
+        for (std::size_t n = first; n < slices; ++n) {
+            const auto prediction = coarse(start[n]);
+            for (std::size_t i = 0; i < System::stateSize; ++i) {
+                const double corrected = prediction[i] + fine[n][i] - predicted[n][i];
+                const double scale = std::max(1.0, std::abs(corrected));
+                report.correction = std::max(report.correction, std::abs(corrected - start[n + 1][i]) / scale);
+                start[n + 1][i] = corrected;
+            }
+            predicted[n] = prediction;
+        }
+        ++report.iterations;
+        if (report.correction < options.tolerance) {
+            break;
+        }
+    }
+    std::ranges::copy(start[slices], states.begin());
+    return report;
+}
+
+} // namespace codys
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <codys/CostModel.hpp>
+#include <codys/Operators.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+namespace detail
+{
+
+// weighted operation count, used to balance groups
+template <typename Expression>
+struct evaluation_cost
+{
+    constexpr static std::size_t value = expression_cost_v<Expression>.weighted();
+};
+
+} // namespace detail
+
+template <typename Derivatives, std::size_t maxGroups = parallel_evaluation_groups>
+struct equation_partition;
+
+// Spreads the equations over at most maxGroups groups of similar cost, most
+// expensive equation first into the cheapest group (LPT). Any grouping is
+// valid for evaluation, since every equation only reads statesIn and writes
+// its own outputs, so equations coupled through shared quantities may end up
+// in different groups. Groups that would stay empty are dropped.
+template <typename... Derivative, std::size_t maxGroups>
+struct equation_partition<std::tuple<Derivative...>, maxGroups>
+{
+    static_assert(maxGroups > 0, "a partition needs at least one group");
+
+    constexpr static std::size_t equationCount = sizeof...(Derivative);
+
+    constexpr static std::array<std::size_t, equationCount> equationCost{
+        (Derivative::extent * detail::evaluation_cost<typename Derivative::Expression>::value)...};
+
+    constexpr static std::size_t totalCost = (std::size_t{0} + ... + (Derivative::extent * detail::evaluation_cost<typename Derivative::Expression>::value));
+
+    constexpr static auto groupOf = []() {
+        constexpr std::size_t binCount = std::min(maxGroups, equationCount);
+
+        std::array<std::size_t, equationCount> byCost{};
+        for (std::size_t eq = 0; eq < equationCount; ++eq) {
+            byCost[eq] = eq;
+        }
+        std::ranges::sort(byCost, [](std::size_t lhs, std::size_t rhs) {
+            return equationCost[lhs] != equationCost[rhs] ? equationCost[lhs] > equationCost[rhs] : lhs < rhs;
+        });
+
+        std::array<std::size_t, binCount> load{};
+        std::array<std::size_t, equationCount> bin{};
+        for (const auto eq : byCost) {
+            const auto cheapest = static_cast<std::size_t>(std::ranges::min_element(load) - load.begin());
+            bin[eq] = cheapest;
+            load[cheapest] += equationCost[eq];
+        }
+
+        // renumber to 0..groupCount-1 in order of first appearance
+        std::array<std::size_t, equationCount> group{};
+        std::array<std::size_t, binCount> remap{};
+        std::ranges::fill(remap, equationCount);
+        std::size_t next = 0;
+        for (std::size_t eq = 0; eq < equationCount; ++eq) {
+            if (remap[bin[eq]] == equationCount) {
+                remap[bin[eq]] = next++;
+            }
+            group[eq] = remap[bin[eq]];
+        }
+        return group;
+    }();
+
+    constexpr static std::size_t groupCount = []() {
+        std::size_t count = 0;
+        for (const auto group : groupOf) {
+            count = std::max(count, group + 1);
+        }
+        return count;
+    }();
+
+    constexpr static auto groupCost = []() {
+        std::array<std::size_t, groupCount> cost{};
+        for (std::size_t eq = 0; eq < equationCount; ++eq) {
+            cost[groupOf[eq]] += equationCost[eq];
+        }
+        return cost;
+    }();
+
+    constexpr static auto groupSize = []() {
+        std::array<std::size_t, groupCount> size{};
+        for (const auto group : groupOf) {
+            ++size[group];
+        }
+        return size;
+    }();
+
+    template <std::size_t group>
+    constexpr static auto members = []() {
+        std::array<std::size_t, groupSize[group]> result{};
+        std::size_t pos = 0;
+        for (std::size_t eq = 0; eq < equationCount; ++eq) {
+            if (groupOf[eq] == group) {
+                result[pos++] = eq;
+            }
+        }
+        return result;
+    }();
+
+    // most expensive group first, so dynamic scheduling approximates LPT
+    constexpr static auto dispatchOrder = []() {
+        std::array<std::size_t, groupCount> order{};
+        for (std::size_t group = 0; group < groupCount; ++group) {
+            auto pos = group;
+            for (; pos > 0 && groupCost[order[pos - 1]] < groupCost[group]; --pos) {
+                order[pos] = order[pos - 1];
+            }
+            order[pos] = group;
+        }
+        return order;
+    }();
+};
+
+template <typename System, std::size_t maxGroups = parallel_evaluation_groups>
+using equation_partition_of = equation_partition<std::remove_cvref_t<decltype(System::derivativeFunctions)>, maxGroups>;
+
+template <typename System, std::size_t group, std::size_t maxGroups = parallel_evaluation_groups>
+constexpr void evaluate_group(
+    std::span<const double, System::stateSize + System::controlSize> statesIn,
+    std::span<double, System::stateSize> derivativesOut)
+{
+    using Partition = equation_partition_of<System, maxGroups>;
+    [statesIn, derivativesOut]<std::size_t... memberIdx>(std::index_sequence<memberIdx...> /*members*/) {
+        System::evaluate_equations(
+            std::index_sequence<Partition::template members<group>[memberIdx]...>{},
+            statesIn, derivativesOut);
+    }(std::make_index_sequence<Partition::groupSize[group]>{});
+}
+
+} // namespace codys
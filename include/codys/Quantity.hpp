@@ -42,8 +42,8 @@ struct Quantity {
     using depends_on = std::tuple<Quantity>;
 
     template <class SystemType, std::size_t N>
-    constexpr static double evaluate(std::span<const double, N> arr) {
-        return arr[get_idx<Quantity, SystemType>()];
+    constexpr static double evaluate(std::span<const double, N> arr, std::size_t /*element*/ = 0) {
+        return arr[get_offset<Quantity, SystemType>()];
     }
 
     template <class SystemType>
@@ -57,6 +57,62 @@ struct Quantity {
     }
 };
 
+// N homogeneous quantities (e.g. one per body of a fleet) in consecutive slots
+// of the state span. Expressions over arrays are evaluated element-wise.
+template <typename Tag, typename Unit_, std::size_t N, StringLiteral symbol = "">
+struct QuantityArray {
+    static_assert(N >= 1);
+
+    using Unit = Unit_;
+    using depends_on = std::tuple<QuantityArray>;
+    constexpr static std::size_t extent = N;
+
+    template <class SystemType, std::size_t SpanSize>
+    constexpr static double evaluate(std::span<const double, SpanSize> arr, std::size_t element = 0) {
+        return arr[get_offset<QuantityArray, SystemType>() + element];
+    }
+
+    template <class SystemType>
+    constexpr static auto format_in() {
+        constexpr auto index = get_idx<QuantityArray, SystemType>();
+        constexpr auto compiled = FMT_COMPILE("{{{}}}");
+        constexpr auto size = fmt::formatted_size(compiled, index);
+        auto result = std::array<char, size>();
+        fmt::format_to(result.data(), compiled, index);
+        return result;
+    }
+};
+
+
+// Value of the state Operand `Tau` seconds ago (a std::ratio), x(t - tau).
+// Occupies control slots of its own, which DelayIntegrator fills from the
+// history of Operand.
+template <typename Operand_, typename Tau>
+struct Delayed {
+    static_assert(Tau::num > 0, "delay must be positive");
+
+    using Operand = Operand_;
+    using Unit = typename Operand::Unit;
+    using depends_on = std::tuple<Delayed>;
+    constexpr static std::size_t extent = extent_v<Operand>;
+    constexpr static double delay = static_cast<double>(Tau::num) / static_cast<double>(Tau::den);
+
+    template <class SystemType, std::size_t N>
+    constexpr static double evaluate(std::span<const double, N> arr, std::size_t element = 0) {
+        return arr[get_offset<Delayed, SystemType>() + element];
+    }
+
+    template <class SystemType>
+    constexpr static auto format_in() {
+        constexpr auto index = get_idx<Delayed, SystemType>();
+        constexpr auto compiled = FMT_COMPILE("{{{}}}");
+        constexpr auto size = fmt::formatted_size(compiled, index);
+        auto result = std::array<char, size>();
+        fmt::format_to(result.data(), compiled, index);
+        return result;
+    }
+};
+
 
 template<typename value_, typename Unit_>
 struct ScalarValue
@@ -66,7 +122,7 @@ struct ScalarValue
     constexpr static double value = static_cast<double>(value_::num) / static_cast<double>(value_::den);
 
     template <class SystemType, std::size_t N> 
-    constexpr static double evaluate(std::span<const double, N> /*arr*/) {
+    constexpr static double evaluate(std::span<const double, N> /*arr*/, std::size_t /*element*/ = 0) {
         return value;
     }
 
@@ -110,4 +166,47 @@ struct fmt::formatter<::codys::Quantity<Tag, Unit_, symbol>>
             symbol.toStringView()
         );
     }
+};
+
+template <typename Tag, typename Unit_, std::size_t N, ::codys::StringLiteral symbol>
+struct fmt::formatter<::codys::QuantityArray<Tag, Unit_, N, symbol>>
+{
+    template <typename ParseContext>
+    // ReSharper disable once CppMemberFunctionMayBeStatic
+    constexpr auto parse(ParseContext& ctx)
+    {
+        return ctx.begin();
+    }
+
+    template <typename FormatContext>
+    constexpr auto format(const ::codys::QuantityArray<Tag, Unit_, N, symbol>& /*quantity*/, FormatContext& ctx) const
+    {
+        return fmt::format_to(
+            ctx.out(),
+            "{}_i(t)", 
+            symbol.toStringView()
+        );
+    }
+};
+
+template <typename Operand, typename Tau>
+struct fmt::formatter<::codys::Delayed<Operand, Tau>>
+{
+    template <typename ParseContext>
+    // ReSharper disable once CppMemberFunctionMayBeStatic
+    constexpr auto parse(ParseContext& ctx)
+    {
+        return ctx.begin();
+    }
+
+    template <typename FormatContext>
+    constexpr auto format(const ::codys::Delayed<Operand, Tau>& /*quantity*/, FormatContext& ctx) const
+    {
+        return fmt::format_to(
+            ctx.out(),
+            "delay({}, {})",
+            Operand{},
+            ::codys::Delayed<Operand, Tau>::delay
+        );
+    }
 };
\ No newline at end of file
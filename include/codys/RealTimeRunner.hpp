@@ -0,0 +1,285 @@
+#pragma once
+
+#include <codys/Integrator.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace codys
+{
+
+// std::hardware_destructive_interference_size is not ABI stable across compiler flags
+constexpr std::size_t cache_line_size = 64;
+
+// Wait-free single-producer single-consumer queue with inline storage.
+template <typename T, std::size_t Capacity>
+class SpscRing
+{
+    static_assert(std::has_single_bit(Capacity), "capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    // producer side
+    bool try_push(const T& value)
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head - cachedTail_ == Capacity) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head - cachedTail_ == Capacity) {
+                return false;
+            }
+        }
+        slots_[head & (Capacity - 1)] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side
+    bool try_pop(T& value)
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cachedHead_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail == cachedHead_) {
+                return false;
+            }
+        }
+        value = slots_[tail & (Capacity - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] constexpr static std::size_t capacity()
+    {
+        return Capacity;
+    }
+
+private:
+    alignas(cache_line_size) std::atomic<std::size_t> head_{0};
+    std::size_t cachedTail_{0};
+    alignas(cache_line_size) std::atomic<std::size_t> tail_{0};
+    std::size_t cachedHead_{0};
+    alignas(cache_line_size) std::array<T, Capacity> slots_{};
+};
+
+// Power-of-two buckets of nanoseconds: bucket b counts values in [2^(b-1), 2^b).
+class LatencyHistogram
+{
+public:
+    constexpr static std::size_t bucketCount = 40;
+
+    void record(std::chrono::nanoseconds latency)
+    {
+        const auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(latency.count(), 0));
+        const auto bucket = std::min(static_cast<std::size_t>(64 - std::countl_zero(ns)), bucketCount - 1);
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        auto max = max_.load(std::memory_order_relaxed);
+        while (ns > max && !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    [[nodiscard]] std::uint64_t count(std::size_t bucket) const
+    {
+        return buckets_[bucket].load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t total() const
+    {
+        std::uint64_t result = 0;
+        for (const auto& bucket : buckets_) {
+            result += bucket.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::chrono::nanoseconds max() const
+    {
+        return std::chrono::nanoseconds(max_.load(std::memory_order_relaxed));
+    }
+
+    // upper bound of the bucket holding the given quantile
+    [[nodiscard]] std::chrono::nanoseconds quantile(double q) const
+    {
+        const auto target = static_cast<std::uint64_t>(q * static_cast<double>(total()));
+        std::uint64_t seen = 0;
+        for (std::size_t bucket = 0; bucket < bucketCount; ++bucket) {
+            seen += count(bucket);
+            if (seen > target) {
+                return std::chrono::nanoseconds(std::int64_t{1} << bucket);
+            }
+        }
+        return max();
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, bucketCount> buckets_{};
+    std::atomic<std::uint64_t> max_{0};
+};
+
+template <typename System>
+struct StateSample
+{
+    std::uint64_t step;
+    double time;
+    state_vector_t<System> states;
+};
+
+struct RealTimeOptions
+{
+    std::chrono::nanoseconds period{std::chrono::milliseconds(1)};
+    // pin the stepping thread to this CPU (Linux only)
+    std::optional<int> cpu{};
+    // sleep until this long before the deadline, then spin for low jitter
+    std::chrono::nanoseconds spin{std::chrono::microseconds(50)};
+};
+
+// Steps a system at a fixed period on its own thread. A controller thread
+// pushes control vectors, a logger thread pops state samples; both through
+// SPSC rings. After start() the stepping path neither allocates, locks nor
+// calls into the kernel apart from sleeping between steps.
+template <typename System, FixedStepper<System> Stepper = RungeKutta4,
+          std::size_t ControlCapacity = 64, std::size_t StateCapacity = 1024>
+class RealTimeRunner
+{
+public:
+    using Controls = control_vector_t<System>;
+    using Sample = StateSample<System>;
+
+    RealTimeRunner(RealTimeOptions options, const state_vector_t<System>& initialStates,
+                   const Controls& initialControls = {})
+        : options_(options), states_(initialStates), controls_(initialControls)
+    {
+    }
+
+    RealTimeRunner(const RealTimeRunner&) = delete;
+    RealTimeRunner(RealTimeRunner&&) = delete;
+    RealTimeRunner& operator=(const RealTimeRunner&) = delete;
+    RealTimeRunner& operator=(RealTimeRunner&&) = delete;
+
+    ~RealTimeRunner()
+    {
+        stop();
+    }
+
+    void start()
+    {
+        thread_ = std::jthread([this](const std::stop_token& stop) { run(stop); });
+    }
+
+    void stop()
+    {
+        if (thread_.joinable()) {
+            thread_.request_stop();
+            thread_.join();
+        }
+    }
+
+    // controller thread; the latest pushed vector applies from the next step
+    bool push_controls(const Controls& controls)
+    {
+        return controlQueue_.try_push(controls);
+    }
+
+    // logger thread
+    bool pop_state(Sample& sample)
+    {
+        return stateQueue_.try_pop(sample);
+    }
+
+    [[nodiscard]] bool pinned() const { return pinned_.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t steps() const { return steps_.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t missed_deadlines() const { return missedDeadlines_.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t dropped_samples() const { return droppedSamples_.load(std::memory_order_relaxed); }
+    // time from the release of a step until its state sample is published
+    [[nodiscard]] const LatencyHistogram& step_latency() const { return stepLatency_; }
+    // lateness of the release against the ideal period grid
+    [[nodiscard]] const LatencyHistogram& release_jitter() const { return releaseJitter_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void pin()
+    {
+#if defined(__linux__)
+        if (options_.cpu) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(static_cast<std::size_t>(*options_.cpu), &set);
+            pinned_.store(pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0, std::memory_order_relaxed);
+        }
+#endif
+    }
+
+    void run(const std::stop_token& stop)
+    {
+        pin();
+        const double dt = std::chrono::duration<double>(options_.period).count();
+        std::uint64_t step = 0;
+        auto deadline = Clock::now() + options_.period;
+
+        while (!stop.stop_requested()) {
+            std::this_thread::sleep_until(deadline - options_.spin);
+            auto released = Clock::now();
+            while (released < deadline) {
+                released = Clock::now();
+            }
+            releaseJitter_.record(released - deadline);
+
+            Controls latest{};
+            bool received = false;
+            while (controlQueue_.try_pop(latest)) {
+                received = true;
+            }
+            if (received) {
+                controls_ = latest;
+            }
+
+            Stepper::template step<System>(states_, controls_, dt);
+            ++step;
+
+            if (!stateQueue_.try_push(Sample{step, static_cast<double>(step) * dt, states_})) {
+                droppedSamples_.fetch_add(1, std::memory_order_relaxed);
+            }
+            steps_.store(step, std::memory_order_relaxed);
+
+            const auto finished = Clock::now();
+            stepLatency_.record(finished - released);
+
+            deadline += options_.period;
+            if (finished > deadline) {
+                // overran: count the periods that were skipped and realign
+                const auto overrun = (finished - deadline) / options_.period + 1;
+                missedDeadlines_.fetch_add(static_cast<std::uint64_t>(overrun), std::memory_order_relaxed);
+                deadline += overrun * options_.period;
+            }
+        }
+    }
+
+    RealTimeOptions options_;
+    state_vector_t<System> states_;
+    Controls controls_;
+    SpscRing<Controls, ControlCapacity> controlQueue_;
+    SpscRing<Sample, StateCapacity> stateQueue_;
+    LatencyHistogram stepLatency_;
+    LatencyHistogram releaseJitter_;
+    std::atomic<std::uint64_t> steps_{0};
+    std::atomic<std::uint64_t> missedDeadlines_{0};
+    std::atomic<std::uint64_t> droppedSamples_{0};
+    std::atomic<bool> pinned_{false};
+    std::jthread thread_;
+};
+
+} // namespace codys
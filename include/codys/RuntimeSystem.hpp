@@ -0,0 +1,658 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Runtime counterpart of the compile-time systems: a model is assembled from
+// text (e.g. a configuration file), its units are checked when it is loaded
+// and its equations are lowered to a straight-line register bytecode.
+
+namespace codys
+{
+
+struct RuntimeUnit
+{
+    // exponents of metre, kilogram, second, ampere, kelvin, mole, candela, radian
+    std::array<int, 8> exponents{};
+
+    constexpr static std::array<std::string_view, 8> symbols{"m", "kg", "s", "A", "K", "mol", "cd", "rad"};
+
+    // e.g. "1", "m/s^2", "kg*m/s^2", "rad/s"
+    [[nodiscard]] static RuntimeUnit parse(std::string_view text)
+    {
+        RuntimeUnit result;
+        int sign = 1;
+        std::size_t pos = 0;
+        const auto skipSpace = [&] {
+            while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])) != 0) {
+                ++pos;
+            }
+        };
+        while (true) {
+            skipSpace();
+            const auto begin = pos;
+            while (pos < text.size() && std::isalnum(static_cast<unsigned char>(text[pos])) != 0) {
+                ++pos;
+            }
+            const auto symbol = text.substr(begin, pos - begin);
+            int exponent = 1;
+            skipSpace();
+            if (pos < text.size() && text[pos] == '^') {
+                ++pos;
+                skipSpace();
+                const auto* const first = text.data() + pos;
+                const auto [last, ec] = std::from_chars(first, text.data() + text.size(), exponent);
+                if (ec != std::errc{}) {
+                    throw std::invalid_argument("invalid exponent in unit '" + std::string(text) + "'");
+                }
+                pos += static_cast<std::size_t>(last - first);
+            }
+            if (symbol != "1") {
+                const auto* const it = std::ranges::find(symbols, symbol);
+                if (it == symbols.end()) {
+                    throw std::invalid_argument("unknown unit '" + std::string(symbol) + "' in '" + std::string(text) + "'");
+                }
+                result.exponents[static_cast<std::size_t>(it - symbols.begin())] += sign * exponent;
+            }
+            skipSpace();
+            if (pos == text.size()) {
+                return result;
+            }
+            if (text[pos] != '*' && text[pos] != '/') {
+                throw std::invalid_argument("unexpected '" + std::string(1, text[pos]) + "' in unit '" + std::string(text) + "'");
+            }
+            // everything behind the first '/' is in the denominator
+            sign = (text[pos] == '/' || sign < 0) ? -1 : 1;
+            ++pos;
+        }
+    }
+
+    [[nodiscard]] std::string to_string() const
+    {
+        std::string result;
+        for (std::size_t i = 0; i < exponents.size(); ++i) {
+            if (exponents[i] == 0) {
+                continue;
+            }
+            if (!result.empty()) {
+                result += '*';
+            }
+            result += symbols[i];
+            if (exponents[i] != 1) {
+                result += '^' + std::to_string(exponents[i]);
+            }
+        }
+        return result.empty() ? "1" : result;
+    }
+
+    [[nodiscard]] bool is_dimensionless() const
+    {
+        return *this == RuntimeUnit{};
+    }
+
+    friend bool operator==(const RuntimeUnit&, const RuntimeUnit&) = default;
+
+    friend RuntimeUnit operator*(RuntimeUnit lhs, const RuntimeUnit& rhs)
+    {
+        for (std::size_t i = 0; i < lhs.exponents.size(); ++i) {
+            lhs.exponents[i] += rhs.exponents[i];
+        }
+        return lhs;
+    }
+
+    friend RuntimeUnit operator/(RuntimeUnit lhs, const RuntimeUnit& rhs)
+    {
+        for (std::size_t i = 0; i < lhs.exponents.size(); ++i) {
+            lhs.exponents[i] -= rhs.exponents[i];
+        }
+        return lhs;
+    }
+};
+
+// mirrors the expression templates in Operators.hpp
+enum class OpCode : std::uint8_t
+{
+    Add,
+    Substract,
+    Multiply,
+    Divide,
+    Sinus,
+    Cosinus,
+};
+
+struct Instruction
+{
+    OpCode op;
+    std::uint16_t dst;
+    std::uint16_t lhs;
+    std::uint16_t rhs;
+};
+
+// Straight-line program over a register file laid out as
+// [ states..., controls..., constants..., temporaries... ].
+class BytecodeSystem
+{
+public:
+    BytecodeSystem(std::size_t stateSize, std::size_t controlSize, std::vector<double> constants,
+                   std::vector<Instruction> code, std::vector<std::uint16_t> outputs, std::size_t registerCount)
+        : stateSize_(stateSize),
+          controlSize_(controlSize),
+          constants_(std::move(constants)),
+          code_(std::move(code)),
+          outputs_(std::move(outputs)),
+          registers_(registerCount, 0.0)
+    {
+        std::ranges::copy(constants_, registers_.begin() + static_cast<std::ptrdiff_t>(inputSize()));
+    }
+
+    [[nodiscard]] std::size_t stateSize() const { return stateSize_; }
+    [[nodiscard]] std::size_t controlSize() const { return controlSize_; }
+    [[nodiscard]] std::size_t inputSize() const { return stateSize_ + controlSize_; }
+    [[nodiscard]] std::size_t registerCount() const { return registers_.size(); }
+    [[nodiscard]] std::span<const Instruction> code() const { return code_; }
+
+    void evaluate(std::span<const double> statesIn, std::span<double> derivativesOut)
+    {
+        check_size(statesIn.size(), inputSize(), "statesIn");
+        check_size(derivativesOut.size(), stateSize_, "derivativesOut");
+        std::copy_n(statesIn.begin(), inputSize(), registers_.begin());
+        double* const reg = registers_.data();
+        for (const auto& ins : code_) {
+            switch (ins.op) {
+            case OpCode::Add:
+                reg[ins.dst] = reg[ins.lhs] + reg[ins.rhs];
+                break;
+            case OpCode::Substract:
+                reg[ins.dst] = reg[ins.lhs] - reg[ins.rhs];
+                break;
+            case OpCode::Multiply:
+                reg[ins.dst] = reg[ins.lhs] * reg[ins.rhs];
+                break;
+            case OpCode::Divide:
+                reg[ins.dst] = reg[ins.lhs] / reg[ins.rhs];
+                break;
+            case OpCode::Sinus:
+                reg[ins.dst] = std::sin(reg[ins.lhs]);
+                break;
+            case OpCode::Cosinus:
+                reg[ins.dst] = std::cos(reg[ins.lhs]);
+                break;
+            }
+        }
+        for (std::size_t i = 0; i < stateSize_; ++i) {
+            derivativesOut[i] = reg[outputs_[i]];
+        }
+    }
+
+    // Evaluates `lanes` independent systems at once. Inputs and outputs are
+    // stored quantity-major: value of quantity q in lane l is at [q * lanes + l].
+    // Each instruction is one loop over the lanes, which the compiler vectorizes.
+    template <std::size_t lanes>
+    void evaluate_batch(std::span<const double> statesIn, std::span<double> derivativesOut)
+    {
+        check_size(statesIn.size(), inputSize() * lanes, "statesIn");
+        check_size(derivativesOut.size(), stateSize_ * lanes, "derivativesOut");
+        batchRegisters_.resize(registers_.size() * lanes);
+        double* const reg = batchRegisters_.data();
+        std::copy_n(statesIn.begin(), inputSize() * lanes, batchRegisters_.begin());
+        for (std::size_t c = 0; c < constants_.size(); ++c) {
+            std::fill_n(reg + (inputSize() + c) * lanes, lanes, constants_[c]);
+        }
+        for (const auto& ins : code_) {
+            double* const dst = reg + std::size_t{ins.dst} * lanes;
+            const double* const lhs = reg + std::size_t{ins.lhs} * lanes;
+            const double* const rhs = reg + std::size_t{ins.rhs} * lanes;
+            switch (ins.op) {
+            case OpCode::Add:
+                for (std::size_t l = 0; l < lanes; ++l) {
+                    dst[l] = lhs[l] + rhs[l];
+                }
+                break;
+            case OpCode::Substract:
+                for (std::size_t l = 0; l < lanes; ++l) {
+                    dst[l] = lhs[l] - rhs[l];
+                }
+                break;
+            case OpCode::Multiply:
+                for (std::size_t l = 0; l < lanes; ++l) {
+                    dst[l] = lhs[l] * rhs[l];
+                }
+                break;
+            case OpCode::Divide:
+                for (std::size_t l = 0; l < lanes; ++l) {
+                    dst[l] = lhs[l] / rhs[l];
+                }
+                break;
+            case OpCode::Sinus:
+                for (std::size_t l = 0; l < lanes; ++l) {
+                    dst[l] = std::sin(lhs[l]);
+                }
+                break;
+            case OpCode::Cosinus:
+                for (std::size_t l = 0; l < lanes; ++l) {
+                    dst[l] = std::cos(lhs[l]);
+                }
+                break;
+            }
+        }
+        for (std::size_t i = 0; i < stateSize_; ++i) {
+            std::copy_n(reg + std::size_t{outputs_[i]} * lanes, lanes,
+                        derivativesOut.begin() + static_cast<std::ptrdiff_t>(i * lanes));
+        }
+    }
+
+private:
+    static void check_size(std::size_t size, std::size_t expected, const char* name)
+    {
+        if (size != expected) {
+            throw std::invalid_argument(std::string(name) + " holds " + std::to_string(size) + " values instead of " +
+                                        std::to_string(expected));
+        }
+    }
+
+    std::size_t stateSize_;
+    std::size_t controlSize_;
+    std::vector<double> constants_;
+    std::vector<Instruction> code_;
+    std::vector<std::uint16_t> outputs_;
+    std::vector<double> registers_;
+    std::vector<double> batchRegisters_;
+};
+
+// Builder for models that are only known at runtime. Equations use the
+// operators of Operators.hpp: + - * / sin() cos(), parentheses, quantity names
+// and constants with an optional unit in brackets, e.g. "0.5[m/s^2]".
+class RuntimeModel
+{
+public:
+    void add_state(std::string name, std::string_view unit)
+    {
+        if (controlSize() != 0) {
+            throw std::invalid_argument("state '" + name + "' has to be declared before the controls");
+        }
+        declare(std::move(name), RuntimeUnit::parse(unit));
+        ++stateCount_;
+    }
+
+    void add_control(std::string name, std::string_view unit)
+    {
+        declare(std::move(name), RuntimeUnit::parse(unit));
+    }
+
+    void add_derivative(std::string_view state, std::string expression)
+    {
+        const auto idx = index_of(state);
+        if (!idx || *idx >= stateCount_) {
+            throw std::invalid_argument("derivative of unknown state '" + std::string(state) + "'");
+        }
+        derivatives_.emplace_back(*idx, std::move(expression));
+    }
+
+    // Line based model description:
+    //   state <name> <unit>
+    //   control <name> <unit>
+    //   dot <name> = <expression>
+    // Empty lines and lines starting with '#' are ignored.
+    [[nodiscard]] static RuntimeModel parse(std::istream& input)
+    {
+        RuntimeModel model;
+        std::string line;
+        std::size_t lineNumber = 0;
+        while (std::getline(input, line)) {
+            ++lineNumber;
+            std::istringstream tokens(line);
+            std::string keyword;
+            std::string name;
+            if (!(tokens >> keyword) || keyword.starts_with('#')) {
+                continue;
+            }
+            tokens >> name;
+            std::string rest;
+            std::getline(tokens, rest);
+            try {
+                if (keyword == "state") {
+                    model.add_state(name, rest);
+                } else if (keyword == "control") {
+                    model.add_control(name, rest);
+                } else if (keyword == "dot") {
+                    const auto eq = rest.find('=');
+                    if (eq == std::string::npos) {
+                        throw std::invalid_argument("expected '=' after 'dot " + name + "'");
+                    }
+                    model.add_derivative(name, rest.substr(eq + 1));
+                } else {
+                    throw std::invalid_argument("unknown keyword '" + keyword + "'");
+                }
+            } catch (const std::invalid_argument& error) {
+                throw std::invalid_argument("line " + std::to_string(lineNumber) + ": " + error.what());
+            }
+        }
+        return model;
+    }
+
+    [[nodiscard]] std::size_t stateSize() const { return stateCount_; }
+    [[nodiscard]] std::size_t controlSize() const { return names_.size() - stateCount_; }
+
+    [[nodiscard]] BytecodeSystem compile() const
+    {
+        for (std::size_t state = 0; state < stateCount_; ++state) {
+            const auto count = std::ranges::count_if(derivatives_, [state](const auto& derivative) {
+                return derivative.first == state;
+            });
+            if (count != 1) {
+                throw std::invalid_argument("state '" + names_[state] + "' needs exactly one derivative");
+            }
+        }
+
+        Lowering lowering(*this);
+        std::vector<Lowering::Ref> outputs(stateCount_);
+        for (const auto& [state, expression] : derivatives_) {
+            const auto [reg, unit] = lowering.lower(expression);
+            const auto expected = units_[state] / RuntimeUnit::parse("s");
+            if (unit != expected) {
+                throw std::invalid_argument("derivative of '" + names_[state] + "' has unit " + unit.to_string() +
+                                            ", expected " + expected.to_string());
+            }
+            outputs[state] = reg;
+        }
+        return lowering.finish(outputs);
+    }
+
+private:
+    class Lowering
+    {
+    public:
+        explicit Lowering(const RuntimeModel& model) : model_(model) {}
+
+        // operands of a quantity, a constant or an earlier instruction
+        struct Ref
+        {
+            enum class Kind : std::uint8_t
+            {
+                Input,
+                Constant,
+                Temporary,
+            };
+            Kind kind;
+            std::size_t index;
+
+            friend auto operator<=>(const Ref&, const Ref&) = default;
+        };
+
+        std::pair<Ref, RuntimeUnit> lower(std::string_view expression)
+        {
+            text_ = expression;
+            pos_ = 0;
+            auto result = parse_sum();
+            skip_space();
+            if (pos_ != text_.size()) {
+                fail("unexpected '" + std::string(1, text_[pos_]) + "'");
+            }
+            return result;
+        }
+
+        BytecodeSystem finish(const std::vector<Ref>& outputs) const
+        {
+            // Temporaries are in SSA form, reuse their registers after the last read.
+            std::vector<std::size_t> lastUse(code_.size(), 0);
+            for (std::size_t i = 0; i < code_.size(); ++i) {
+                for (const auto& source : {code_[i].lhs, code_[i].rhs}) {
+                    if (source.kind == Ref::Kind::Temporary) {
+                        lastUse[source.index] = i;
+                    }
+                }
+            }
+            for (const auto& output : outputs) {
+                if (output.kind == Ref::Kind::Temporary) {
+                    lastUse[output.index] = std::numeric_limits<std::size_t>::max();
+                }
+            }
+
+            const auto fixed = model_.names_.size() + constants_.size();
+            std::vector<std::size_t> temporary(code_.size());
+            const auto physical = [&](const Ref& ref) {
+                switch (ref.kind) {
+                case Ref::Kind::Input:
+                    return ref.index;
+                case Ref::Kind::Constant:
+                    return model_.names_.size() + ref.index;
+                case Ref::Kind::Temporary:
+                    break;
+                }
+                return temporary[ref.index];
+            };
+
+            std::vector<std::size_t> freeRegisters;
+            std::size_t registerCount = fixed;
+            std::vector<Instruction> code;
+            code.reserve(code_.size());
+            for (std::size_t i = 0; i < code_.size(); ++i) {
+                const auto& [op, lhs, rhs] = code_[i];
+                for (const auto& source : {lhs, rhs}) {
+                    if (source.kind == Ref::Kind::Temporary && lastUse[source.index] == i &&
+                        std::ranges::find(freeRegisters, temporary[source.index]) == freeRegisters.end()) {
+                        freeRegisters.push_back(temporary[source.index]);
+                    }
+                }
+                if (freeRegisters.empty()) {
+                    temporary[i] = registerCount++;
+                } else {
+                    temporary[i] = freeRegisters.back();
+                    freeRegisters.pop_back();
+                }
+                code.push_back({op, narrow(temporary[i]), narrow(physical(lhs)), narrow(physical(rhs))});
+            }
+
+            std::vector<std::uint16_t> outputRegisters;
+            outputRegisters.reserve(outputs.size());
+            for (const auto& output : outputs) {
+                outputRegisters.push_back(narrow(physical(output)));
+            }
+            return BytecodeSystem(model_.stateCount_, model_.controlSize(), constants_, std::move(code),
+                                  std::move(outputRegisters), registerCount);
+        }
+
+    private:
+        using Value = std::pair<Ref, RuntimeUnit>;
+
+        struct Operation
+        {
+            OpCode op;
+            Ref lhs;
+            Ref rhs;
+
+            friend auto operator<=>(const Operation&, const Operation&) = default;
+        };
+
+        [[noreturn]] void fail(const std::string& message) const
+        {
+            throw std::invalid_argument(message + " in '" + std::string(text_) + "'");
+        }
+
+        static std::uint16_t narrow(std::size_t reg)
+        {
+            if (reg > std::numeric_limits<std::uint16_t>::max()) {
+                throw std::invalid_argument("model exceeds the register file of the bytecode");
+            }
+            return static_cast<std::uint16_t>(reg);
+        }
+
+        void skip_space()
+        {
+            while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_])) != 0) {
+                ++pos_;
+            }
+        }
+
+        bool consume(char expected)
+        {
+            skip_space();
+            if (pos_ < text_.size() && text_[pos_] == expected) {
+                ++pos_;
+                return true;
+            }
+            return false;
+        }
+
+        // value numbering: identical operations on identical operands share a register
+        Ref emit(OpCode op, Ref lhs, Ref rhs)
+        {
+            if ((op == OpCode::Add || op == OpCode::Multiply) && rhs < lhs) {
+                std::swap(lhs, rhs);
+            }
+            const Operation operation{op, lhs, rhs};
+            if (const auto it = numbering_.find(operation); it != numbering_.end()) {
+                return it->second;
+            }
+            const Ref result{Ref::Kind::Temporary, code_.size()};
+            code_.push_back(operation);
+            numbering_.emplace(operation, result);
+            return result;
+        }
+
+        Value parse_sum()
+        {
+            auto lhs = parse_product();
+            while (true) {
+                const bool plus = consume('+');
+                if (!plus && !consume('-')) {
+                    return lhs;
+                }
+                const auto rhs = parse_product();
+                if (lhs.second != rhs.second) {
+                    fail("cannot add " + lhs.second.to_string() + " and " + rhs.second.to_string());
+                }
+                lhs.first = emit(plus ? OpCode::Add : OpCode::Substract, lhs.first, rhs.first);
+            }
+        }
+
+        Value parse_product()
+        {
+            auto lhs = parse_factor();
+            while (true) {
+                const bool times = consume('*');
+                if (!times && !consume('/')) {
+                    return lhs;
+                }
+                const auto rhs = parse_factor();
+                lhs.first = emit(times ? OpCode::Multiply : OpCode::Divide, lhs.first, rhs.first);
+                lhs.second = times ? lhs.second * rhs.second : lhs.second / rhs.second;
+            }
+        }
+
+        Value parse_factor()
+        {
+            skip_space();
+            if (consume('(')) {
+                auto inner = parse_sum();
+                if (!consume(')')) {
+                    fail("expected ')'");
+                }
+                return inner;
+            }
+            if (pos_ < text_.size() && (std::isdigit(static_cast<unsigned char>(text_[pos_])) != 0 || text_[pos_] == '.')) {
+                return parse_constant();
+            }
+            const auto begin = pos_;
+            while (pos_ < text_.size() && (std::isalnum(static_cast<unsigned char>(text_[pos_])) != 0 || text_[pos_] == '_')) {
+                ++pos_;
+            }
+            const auto name = text_.substr(begin, pos_ - begin);
+            if (name.empty()) {
+                fail("expected a quantity, constant or function");
+            }
+            if (name == "sin" || name == "cos") {
+                if (!consume('(')) {
+                    fail("expected '(' after " + std::string(name));
+                }
+                const auto argument = parse_sum();
+                if (!consume(')')) {
+                    fail("expected ')'");
+                }
+                if (!argument.second.is_dimensionless() && argument.second != RuntimeUnit::parse("rad")) {
+                    fail(std::string(name) + " of " + argument.second.to_string());
+                }
+                return {emit(name == "sin" ? OpCode::Sinus : OpCode::Cosinus, argument.first, argument.first), RuntimeUnit{}};
+            }
+            const auto idx = model_.index_of(name);
+            if (!idx) {
+                fail("unknown quantity '" + std::string(name) + "'");
+            }
+            return {{Ref::Kind::Input, *idx}, model_.units_[*idx]};
+        }
+
+        Value parse_constant()
+        {
+            double value = 0.0;
+            const auto* const first = text_.data() + pos_;
+            const auto [last, ec] = std::from_chars(first, text_.data() + text_.size(), value);
+            if (ec != std::errc{}) {
+                fail("invalid number");
+            }
+            pos_ += static_cast<std::size_t>(last - first);
+            RuntimeUnit unit;
+            if (consume('[')) {
+                const auto end = text_.find(']', pos_);
+                if (end == std::string_view::npos) {
+                    fail("expected ']'");
+                }
+                unit = RuntimeUnit::parse(text_.substr(pos_, end - pos_));
+                pos_ = end + 1;
+            }
+            const auto it = std::ranges::find(constants_, value);
+            const auto idx = static_cast<std::size_t>(it - constants_.begin());
+            if (it == constants_.end()) {
+                constants_.push_back(value);
+            }
+            return {{Ref::Kind::Constant, idx}, unit};
+        }
+
+        const RuntimeModel& model_;
+        std::string_view text_;
+        std::size_t pos_{0};
+        std::vector<double> constants_;
+        std::vector<Operation> code_;
+        std::map<Operation, Ref> numbering_;
+    };
+
+    void declare(std::string name, RuntimeUnit unit)
+    {
+        if (index_of(name)) {
+            throw std::invalid_argument("quantity '" + name + "' declared twice");
+        }
+        names_.push_back(std::move(name));
+        units_.push_back(unit);
+    }
+
+    [[nodiscard]] std::optional<std::size_t> index_of(std::string_view name) const
+    {
+        const auto it = std::ranges::find(names_, name);
+        if (it == names_.end()) {
+            return std::nullopt;
+        }
+        return static_cast<std::size_t>(it - names_.begin());
+    }
+
+    std::vector<std::string> names_;
+    std::vector<RuntimeUnit> units_;
+    std::size_t stateCount_{0};
+    std::vector<std::pair<std::size_t, std::string>> derivatives_;
+};
+
+} // namespace codys
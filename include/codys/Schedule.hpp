@@ -0,0 +1,234 @@
+#pragma once
+
+#include <codys/Derivative.hpp>
+#include <codys/Operators.hpp>
+#include <codys/Simplify.hpp>
+#include <codys/Table.hpp>
+#include <codys/tuple_utilities.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+// Whether systems contract products added to something into fused
+// multiply-adds. Opt-in through the codys_FMA_CONTRACTION CMake option, which
+// defines CODYS_FMA_CONTRACTION for every target linking codys, so all
+// translation units agree on the expression types of a system. Only worth it
+// where std::fma is an instruction (FP_FAST_FMA). Contracted systems stay
+// usable in constant expressions, but round unfused there.
+#if defined(CODYS_FMA_CONTRACTION)
+constexpr bool fma_contraction = true;
+#else
+constexpr bool fma_contraction = false;
+#endif
+
+// Evaluation order of an expression type. Chains of additions and
+// subtractions, as built by combine or simplify, become balanced trees, so
+// the depth of a sum of n terms is log2(n) instead of n - 1 and the CPU can
+// add independent terms in parallel. Subtracted terms are summed on their
+// own and subtracted once. With `contract`, a product added to something
+// becomes a FusedMultiplyAdd. Both change the rounding of the result.
+template <typename Expression, bool contract = fma_contraction>
+struct schedule
+{
+    using type = Expression;
+};
+
+template <typename Expression, bool contract = fma_contraction>
+using schedule_t = typename schedule<Expression, contract>::type;
+
+namespace detail
+{
+
+// scheduled terms of a chain of additions and subtractions, by sign
+template <typename Expression, bool contract>
+struct signed_terms
+{
+    using Positive = std::tuple<schedule_t<Expression, contract>>;
+    using Negative = std::tuple<>;
+};
+
+template <typename Lhs, typename Rhs, bool contract>
+struct signed_terms<Add<Lhs, Rhs>, contract>
+{
+    using Positive = tuple_cat_t<typename signed_terms<Lhs, contract>::Positive, typename signed_terms<Rhs, contract>::Positive>;
+    using Negative = tuple_cat_t<typename signed_terms<Lhs, contract>::Negative, typename signed_terms<Rhs, contract>::Negative>;
+};
+
+template <typename Lhs, typename Rhs, bool contract>
+struct signed_terms<Substract<Lhs, Rhs>, contract>
+{
+    using Positive = tuple_cat_t<typename signed_terms<Lhs, contract>::Positive, typename signed_terms<Rhs, contract>::Negative>;
+    using Negative = tuple_cat_t<typename signed_terms<Lhs, contract>::Negative, typename signed_terms<Rhs, contract>::Positive>;
+};
+
+template <typename Augend, typename Addend, bool contract>
+struct scheduled_add
+{
+    using type = Add<Augend, Addend>;
+};
+
+template <typename Lhs, typename Rhs, typename Addend>
+struct scheduled_add<Multiply<Lhs, Rhs>, Addend, true>
+{
+    using type = FusedMultiplyAdd<Lhs, Rhs, Addend>;
+};
+
+template <typename Augend, typename Lhs, typename Rhs>
+struct scheduled_add<Augend, Multiply<Lhs, Rhs>, true>
+{
+    using type = FusedMultiplyAdd<Lhs, Rhs, Augend>;
+};
+
+template <typename Lhs, typename Rhs, typename OtherLhs, typename OtherRhs>
+struct scheduled_add<Multiply<Lhs, Rhs>, Multiply<OtherLhs, OtherRhs>, true>
+{
+    using type = FusedMultiplyAdd<Lhs, Rhs, Multiply<OtherLhs, OtherRhs>>;
+};
+
+template <typename Tuple, std::size_t offset, typename Indices>
+struct slice;
+
+template <typename Tuple, std::size_t offset, std::size_t... idx>
+struct slice<Tuple, offset, std::index_sequence<idx...>>
+{
+    using type = std::tuple<std::tuple_element_t<offset + idx, Tuple>...>;
+};
+
+template <typename Tuple, std::size_t offset, std::size_t count>
+using slice_t = typename slice<Tuple, offset, std::make_index_sequence<count>>::type;
+
+template <typename Terms, bool contract>
+struct balanced_sum
+{
+    constexpr static std::size_t size = std::tuple_size_v<Terms>;
+    constexpr static std::size_t half = size / 2;
+    using type = typename scheduled_add<typename balanced_sum<slice_t<Terms, 0, half>, contract>::type,
+                                        typename balanced_sum<slice_t<Terms, half, size - half>, contract>::type,
+                                        contract>::type;
+};
+
+template <typename Term, bool contract>
+struct balanced_sum<std::tuple<Term>, contract>
+{
+    using type = Term;
+};
+
+template <typename Positive, typename Negative, bool contract>
+struct difference
+{
+    using type = Substract<typename balanced_sum<Positive, contract>::type, typename balanced_sum<Negative, contract>::type>;
+};
+
+template <typename Positive, bool contract>
+struct difference<Positive, std::tuple<>, contract>
+{
+    using type = typename balanced_sum<Positive, contract>::type;
+};
+
+template <typename Expression, bool contract>
+using scheduled_sum_t = typename difference<typename signed_terms<Expression, contract>::Positive,
+                                            typename signed_terms<Expression, contract>::Negative, contract>::type;
+
+} // namespace detail
+
+template <typename Lhs, typename Rhs, bool contract>
+struct schedule<Add<Lhs, Rhs>, contract>
+{
+    using type = detail::scheduled_sum_t<Add<Lhs, Rhs>, contract>;
+};
+
+template <typename Lhs, typename Rhs, bool contract>
+struct schedule<Substract<Lhs, Rhs>, contract>
+{
+    using type = detail::scheduled_sum_t<Substract<Lhs, Rhs>, contract>;
+};
+
+template <typename Lhs, typename Rhs, bool contract>
+struct schedule<Multiply<Lhs, Rhs>, contract>
+{
+    using type = Multiply<schedule_t<Lhs, contract>, schedule_t<Rhs, contract>>;
+};
+
+template <typename Lhs, typename Rhs, bool contract>
+struct schedule<Divide<Lhs, Rhs>, contract>
+{
+    using type = Divide<schedule_t<Lhs, contract>, schedule_t<Rhs, contract>>;
+};
+
+template <typename Lhs, typename Rhs, typename Addend, bool contract>
+struct schedule<FusedMultiplyAdd<Lhs, Rhs, Addend>, contract>
+{
+    using type = FusedMultiplyAdd<schedule_t<Lhs, contract>, schedule_t<Rhs, contract>, schedule_t<Addend, contract>>;
+};
+
+template <typename Lhs, bool contract>
+struct schedule<Sinus<Lhs>, contract>
+{
+    using type = Sinus<schedule_t<Lhs, contract>>;
+};
+
+template <typename Lhs, bool contract>
+struct schedule<Cosinus<Lhs>, contract>
+{
+    using type = Cosinus<schedule_t<Lhs, contract>>;
+};
+
+template <typename Lhs, bool contract>
+struct schedule<Sum<Lhs>, contract>
+{
+    using type = Sum<schedule_t<Lhs, contract>>;
+};
+
+template <typename Lhs, typename Rhs, bool contract>
+struct schedule<Min<Lhs, Rhs>, contract>
+{
+    using type = Min<schedule_t<Lhs, contract>, schedule_t<Rhs, contract>>;
+};
+
+template <typename Lhs, typename Rhs, bool contract>
+struct schedule<Max<Lhs, Rhs>, contract>
+{
+    using type = Max<schedule_t<Lhs, contract>, schedule_t<Rhs, contract>>;
+};
+
+template <typename Lhs, typename Rhs, bool contract>
+struct schedule<Less<Lhs, Rhs>, contract>
+{
+    using type = Less<schedule_t<Lhs, contract>, schedule_t<Rhs, contract>>;
+};
+
+template <typename Condition, typename OnTrue, typename OnFalse, bool contract>
+struct schedule<Select<Condition, OnTrue, OnFalse>, contract>
+{
+    using type = Select<schedule_t<Condition, contract>, schedule_t<OnTrue, contract>, schedule_t<OnFalse, contract>>;
+};
+
+template <typename Table, typename... Arguments, bool contract>
+struct schedule<Lookup<Table, Arguments...>, contract>
+{
+    using type = Lookup<Table, schedule_t<Arguments, contract>...>;
+};
+
+template <typename Operand, typename Expression, bool contract>
+struct schedule<Derivative<Operand, Expression>, contract>
+{
+    using type = Derivative<Operand, schedule_t<Expression, contract>>;
+};
+
+// form in which a StateSpaceSystem evaluates an expression
+template <typename Expression>
+using evaluated_t = schedule_t<simplify_t<Expression>>;
+
+template <typename... Derivatives>
+constexpr auto evaluated_derivatives(std::tuple<Derivatives...> /*derivatives*/)
+{
+    return std::tuple<evaluated_t<Derivatives>...>{};
+}
+
+} // namespace codys
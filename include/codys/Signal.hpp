@@ -0,0 +1,206 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Integrator.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace codys
+{
+
+enum class SignalShape
+{
+    ZeroOrderHold,
+    Linear,
+    Spline, // natural cubic spline
+};
+
+// one entry of a recorded log
+struct SignalSample
+{
+    double time;
+    double value;
+};
+
+// A control input as a function of time, from samples on a strictly
+// increasing time grid. Between samples it is a polynomial in the time since
+// the last sample, so every shape is evaluated the same way; before the first
+// and after the last sample the signal holds the value of that sample.
+// Samples take a cursor owned by the caller, which moves to the segment of
+// the requested time, so lookups at increasing times cost amortized O(1).
+class Signal
+{
+public:
+    constexpr Signal() : Signal(0.0) {}
+
+    // `value` at all times
+    constexpr explicit Signal(double value) : times_{0.0}, segments_{{value, 0.0, 0.0, 0.0}} {}
+
+    constexpr Signal(SignalShape shape, std::span<const double> times, std::span<const double> values)
+        : times_(times.begin(), times.end())
+    {
+        if (times.empty() || times.size() != values.size()) {
+            throw std::invalid_argument("signal needs as many values as times, and at least one");
+        }
+        for (std::size_t i = 1; i < times.size(); ++i) {
+            if (!(times[i] > times[i - 1])) {
+                throw std::invalid_argument("signal times must be strictly increasing");
+            }
+        }
+        fit(shape, values);
+    }
+
+    constexpr Signal(SignalShape shape, std::span<const SignalSample> log)
+        : Signal(shape, column(log, &SignalSample::time), column(log, &SignalSample::value))
+    {
+    }
+
+    [[nodiscard]] constexpr double sample(double t, std::size_t& cursor) const
+    {
+        locate(t, cursor);
+        return segment_value(cursor, t);
+    }
+
+    // out[lane] = sample(times[lane], cursors[lane]). The lanes of a block
+    // are located before their polynomials are evaluated in one straight
+    // loop, which the compiler vectorizes.
+    void sample_batch(std::span<const double> times, std::span<std::size_t> cursors, std::span<double> out) const
+    {
+        constexpr std::size_t lanes = 8;
+        std::array<double, lanes> tau{};
+        std::array<std::array<double, 4>, lanes> coefficients{};
+        for (std::size_t first = 0; first < out.size(); first += lanes) {
+            const auto count = std::min(lanes, out.size() - first);
+            for (std::size_t lane = 0; lane < count; ++lane) {
+                auto& cursor = cursors[first + lane];
+                locate(times[first + lane], cursor);
+                tau[lane] = std::max(times[first + lane] - times_[cursor], 0.0);
+                coefficients[lane] = segments_[cursor];
+            }
+            for (std::size_t lane = 0; lane < count; ++lane) {
+                const auto& c = coefficients[lane];
+                out[first + lane] = c[0] + tau[lane] * (c[1] + tau[lane] * (c[2] + tau[lane] * c[3]));
+            }
+        }
+    }
+
+private:
+    constexpr static std::vector<double> column(std::span<const SignalSample> log, double SignalSample::*field)
+    {
+        std::vector<double> result;
+        result.reserve(log.size());
+        for (const auto& entry : log) {
+            result.push_back(entry.*field);
+        }
+        return result;
+    }
+
+    constexpr void fit(SignalShape shape, std::span<const double> values)
+    {
+        const auto n = values.size();
+        segments_.assign(n, {0.0, 0.0, 0.0, 0.0});
+        for (std::size_t i = 0; i < n; ++i) {
+            segments_[i][0] = values[i];
+        }
+        if (shape == SignalShape::ZeroOrderHold || n < 2) {
+            return;
+        }
+        if (shape == SignalShape::Linear) {
+            for (std::size_t i = 0; i + 1 < n; ++i) {
+                segments_[i][1] = (values[i + 1] - values[i]) / (times_[i + 1] - times_[i]);
+            }
+            return;
+        }
+        // second derivatives, zero at both ends, by the Thomas algorithm
+        std::vector<double> curvature(n, 0.0);
+        std::vector<double> diagonal(n, 1.0);
+        std::vector<double> rhs(n, 0.0);
+        for (std::size_t i = 1; i + 1 < n; ++i) {
+            const double before = times_[i] - times_[i - 1];
+            const double after = times_[i + 1] - times_[i];
+            const double factor = i == 1 ? 0.0 : before / diagonal[i - 1];
+            diagonal[i] = 2.0 * (before + after) - factor * before;
+            rhs[i] = 6.0 * ((values[i + 1] - values[i]) / after - (values[i] - values[i - 1]) / before) - factor * rhs[i - 1];
+        }
+        for (std::size_t i = n - 1; i-- > 1;) {
+            curvature[i] = (rhs[i] - (times_[i + 1] - times_[i]) * curvature[i + 1]) / diagonal[i];
+        }
+        for (std::size_t i = 0; i + 1 < n; ++i) {
+            const double h = times_[i + 1] - times_[i];
+            segments_[i][1] = (values[i + 1] - values[i]) / h - h * (2.0 * curvature[i] + curvature[i + 1]) / 6.0;
+            segments_[i][2] = curvature[i] / 2.0;
+            segments_[i][3] = (curvature[i + 1] - curvature[i]) / (6.0 * h);
+        }
+    }
+
+    // moves cursor to the last sample at or before t, or the first sample
+    constexpr void locate(double t, std::size_t& cursor) const
+    {
+        cursor = std::min(cursor, times_.size() - 1);
+        while (cursor + 1 < times_.size() && times_[cursor + 1] <= t) {
+            ++cursor;
+        }
+        while (cursor > 0 && times_[cursor] > t) {
+            --cursor;
+        }
+    }
+
+    [[nodiscard]] constexpr double segment_value(std::size_t segment, double t) const
+    {
+        const double tau = std::max(t - times_[segment], 0.0);
+        const auto& c = segments_[segment];
+        return c[0] + tau * (c[1] + tau * (c[2] + tau * c[3]));
+    }
+
+    std::vector<double> times_;
+    // polynomial coefficients of each segment, the last one constant
+    std::vector<std::array<double, 4>> segments_;
+};
+
+// A Signal bound to every control slot of System, zero unless bound. Passed
+// as the controls of a stepper, it is sampled at the time of every stage.
+template <typename System>
+class ControlSignals
+{
+public:
+    constexpr static std::size_t controlSize = System::controlSize;
+
+    template <PhysicalType Control>
+    constexpr void bind(Signal signal, std::size_t element = 0)
+    {
+        constexpr auto offset = get_offset<Control, typename System::AllStates>();
+        static_assert(offset >= System::stateSize, "only controls can be driven by signals");
+        signals_[offset - System::stateSize + element] = std::move(signal);
+    }
+
+    constexpr void sample(double t, std::span<double, controlSize> controls)
+    {
+        for (std::size_t i = 0; i < controlSize; ++i) {
+            controls[i] = signals_[i].sample(t, cursors_[i]);
+        }
+    }
+
+    // controls of `times.size()` lanes, each at its own time, stored
+    // control-major like BytecodeSystem::evaluate_batch: [control * lanes + lane]
+    void sample_batch(std::span<const double> times, std::span<double> controls)
+    {
+        const auto lanes = times.size();
+        batchCursors_.resize(controlSize * lanes);
+        for (std::size_t i = 0; i < controlSize; ++i) {
+            signals_[i].sample_batch(times, std::span(batchCursors_).subspan(i * lanes, lanes), controls.subspan(i * lanes, lanes));
+        }
+    }
+
+private:
+    std::array<Signal, controlSize> signals_{};
+    std::array<std::size_t, controlSize> cursors_{};
+    std::vector<std::size_t> batchCursors_;
+};
+
+} // namespace codys
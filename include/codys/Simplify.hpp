@@ -0,0 +1,643 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Derivative.hpp>
+#include <codys/Operators.hpp>
+#include <codys/Quantity.hpp>
+#include <codys/Table.hpp>
+#include <codys/tuple_utilities.hpp>
+
+#include <units/generic/dimensionless.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <ratio>
+#include <source_location>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+// unit of the numeric coefficients introduced by simplify, e.g. the 2 of 2 * x
+using Dimensionless = units::dimensionless<units::one, double>;
+
+// Algebraically simplified form of an expression type: constants are
+// folded, like terms of sums are collected (x + x -> 2 * x, x - x -> 0),
+// identities and annihilators are removed (x * 1, x / 1, x + 0, x * 0,
+// 0 / x), and numeric coefficients of products are merged in front of them.
+// Divisions by other constants are kept, their reciprocals being inexact.
+// The terms of sums and the operands of products, min and max are put into
+// a canonical order, positive terms first, so equivalent trees become the
+// same type. The order of the terms decides the rounding of a sum; it is the
+// same under every compiler unless terms differ only in unnamed quantities.
+// A rewrite that would change the unit or extent of a node is not applied.
+template <typename Expression>
+struct simplify
+{
+    using type = Expression;
+};
+
+template <typename Expression>
+using simplify_t = typename simplify<Expression>::type;
+
+namespace detail
+{
+
+// What the canonical order of commutative operands compares: the kind of
+// node, the symbol of a quantity, the value of a constant, then the operands.
+// All of it is spelled the same by every compiler.
+template <typename Expression>
+struct order_key
+{
+    constexpr static int rank = 0;
+    constexpr static std::string_view symbol{};
+    constexpr static double value = 0.0;
+    using Operands = std::tuple<>;
+};
+
+template <int rank_, typename... Operands_>
+struct composite_key
+{
+    constexpr static int rank = rank_;
+    constexpr static std::string_view symbol{};
+    constexpr static double value = 0.0;
+    using Operands = std::tuple<Operands_...>;
+};
+
+template <typename Tag, typename Unit_, StringLiteral symbol_>
+struct order_key<Quantity<Tag, Unit_, symbol_>>
+{
+    constexpr static int rank = 1;
+    constexpr static std::string_view symbol = symbol_.toStringView();
+    constexpr static double value = 1.0;
+    using Operands = std::tuple<>;
+};
+
+template <typename Tag, typename Unit_, std::size_t N, StringLiteral symbol_>
+struct order_key<QuantityArray<Tag, Unit_, N, symbol_>>
+{
+    constexpr static int rank = 2;
+    constexpr static std::string_view symbol = symbol_.toStringView();
+    constexpr static double value = static_cast<double>(N);
+    using Operands = std::tuple<>;
+};
+
+template <typename value_, typename Unit_>
+struct order_key<ScalarValue<value_, Unit_>>
+{
+    constexpr static int rank = 3;
+    constexpr static std::string_view symbol{};
+    constexpr static double value = ScalarValue<value_, Unit_>::value;
+    using Operands = std::tuple<>;
+};
+
+template <typename Operand, typename Tau>
+struct order_key<Delayed<Operand, Tau>> : composite_key<4, Operand>
+{
+};
+
+template <typename Lhs, typename Rhs>
+struct order_key<Add<Lhs, Rhs>> : composite_key<5, Lhs, Rhs>
+{
+};
+
+template <typename Lhs, typename Rhs>
+struct order_key<Substract<Lhs, Rhs>> : composite_key<6, Lhs, Rhs>
+{
+};
+
+template <typename Lhs, typename Rhs>
+struct order_key<Multiply<Lhs, Rhs>> : composite_key<7, Lhs, Rhs>
+{
+};
+
+template <typename Lhs, typename Rhs>
+struct order_key<Divide<Lhs, Rhs>> : composite_key<8, Lhs, Rhs>
+{
+};
+
+template <typename Lhs, typename Rhs, typename Addend>
+struct order_key<FusedMultiplyAdd<Lhs, Rhs, Addend>> : composite_key<9, Lhs, Rhs, Addend>
+{
+};
+
+template <typename Lhs>
+struct order_key<Sinus<Lhs>> : composite_key<10, Lhs>
+{
+};
+
+template <typename Lhs>
+struct order_key<Cosinus<Lhs>> : composite_key<11, Lhs>
+{
+};
+
+template <typename Lhs>
+struct order_key<Sum<Lhs>> : composite_key<12, Lhs>
+{
+};
+
+template <typename Lhs, typename Rhs>
+struct order_key<Min<Lhs, Rhs>> : composite_key<13, Lhs, Rhs>
+{
+};
+
+template <typename Lhs, typename Rhs>
+struct order_key<Max<Lhs, Rhs>> : composite_key<14, Lhs, Rhs>
+{
+};
+
+template <typename Lhs, typename Rhs>
+struct order_key<Less<Lhs, Rhs>> : composite_key<15, Lhs, Rhs>
+{
+};
+
+template <typename Condition, typename OnTrue, typename OnFalse>
+struct order_key<Select<Condition, OnTrue, OnFalse>> : composite_key<16, Condition, OnTrue, OnFalse>
+{
+};
+
+template <typename Table, typename... Arguments>
+struct order_key<Lookup<Table, Arguments...>> : composite_key<17, Arguments...>
+{
+};
+
+template <typename Lhs, typename Rhs>
+constexpr int expression_order();
+
+template <typename LhsOperands, typename RhsOperands, std::size_t idx = 0>
+constexpr int operands_order()
+{
+    constexpr auto lhsSize = std::tuple_size_v<LhsOperands>;
+    constexpr auto rhsSize = std::tuple_size_v<RhsOperands>;
+    if constexpr (idx == lhsSize || idx == rhsSize) {
+        return lhsSize == rhsSize ? 0 : (lhsSize < rhsSize ? -1 : 1);
+    } else {
+        constexpr int order = expression_order<std::tuple_element_t<idx, LhsOperands>, std::tuple_element_t<idx, RhsOperands>>();
+        if constexpr (order != 0) {
+            return order;
+        } else {
+            return operands_order<LhsOperands, RhsOperands, idx + 1>();
+        }
+    }
+}
+
+// negative, zero or positive as Lhs orders before, with or after Rhs
+template <typename Lhs, typename Rhs>
+constexpr int expression_order()
+{
+    using LhsKey = order_key<Lhs>;
+    using RhsKey = order_key<Rhs>;
+    if constexpr (std::is_same_v<Lhs, Rhs>) {
+        return 0;
+    } else if constexpr (LhsKey::rank != RhsKey::rank) {
+        return LhsKey::rank < RhsKey::rank ? -1 : 1;
+    } else if constexpr (LhsKey::symbol != RhsKey::symbol) {
+        return LhsKey::symbol < RhsKey::symbol ? -1 : 1;
+    } else if constexpr (LhsKey::value < RhsKey::value || RhsKey::value < LhsKey::value) {
+        return LhsKey::value < RhsKey::value ? -1 : 1;
+    } else {
+        return operands_order<typename LhsKey::Operands, typename RhsKey::Operands>();
+    }
+}
+
+// name of T, which depends on the compiler
+template <typename T>
+consteval std::string_view type_key()
+{
+    return std::source_location::current().function_name();
+}
+
+// Canonical order of the operands of commutative nodes. Only expressions
+// the structural order cannot tell apart, such as two quantities without a
+// symbol, fall back to their compiler-specific type names.
+template <typename Lhs, typename Rhs>
+constexpr bool type_precedes =
+    expression_order<Lhs, Rhs>() != 0 ? expression_order<Lhs, Rhs>() < 0 : type_key<Lhs>() < type_key<Rhs>();
+
+template <typename Original, typename Simplified>
+using guarded_t = std::conditional_t<
+    std::is_same_v<typename Original::Unit, typename Simplified::Unit> && extent_v<Original> == extent_v<Simplified>,
+    Simplified, Original>;
+
+template <typename Expression>
+struct constant_of
+{
+};
+
+template <typename value_, typename Unit_>
+struct constant_of<ScalarValue<value_, Unit_>>
+{
+    using ratio = typename value_::type;
+};
+
+template <typename Expression>
+concept ConstantExpression = requires { typename constant_of<Expression>::ratio; };
+
+template <typename Expression>
+concept ZeroConstant = ConstantExpression<Expression> && constant_of<Expression>::ratio::num == 0;
+
+template <typename Expression>
+concept NonZero = !ZeroConstant<Expression>;
+
+template <typename Expression>
+concept NonZeroConstant = ConstantExpression<Expression> && NonZero<Expression>;
+
+template <typename Expression>
+concept OneConstant = ConstantExpression<Expression> && std::ratio_equal_v<typename constant_of<Expression>::ratio, std::ratio<1>>;
+
+// factor of a pure number
+struct NoFactor
+{
+};
+
+// Expression = Coefficient * Factor, with a rational coefficient as
+// simplified products put it in front
+template <typename Expression>
+struct scaled_split
+{
+    using Coefficient = std::ratio<1>;
+    using Factor = Expression;
+};
+
+template <typename value_>
+struct scaled_split<ScalarValue<value_, Dimensionless>>
+{
+    using Coefficient = typename value_::type;
+    using Factor = NoFactor;
+};
+
+template <typename value_, typename Rhs>
+struct scaled_split<Multiply<ScalarValue<value_, Dimensionless>, Rhs>>
+{
+    using Coefficient = typename value_::type;
+    using Factor = Rhs;
+};
+
+// Coefficient * Factor, in Unit if it is a pure number
+template <typename Coefficient, typename Factor, typename Unit>
+struct scaled
+{
+    using type = std::conditional_t<Coefficient::num == Coefficient::den, Factor,
+                                    Multiply<ScalarValue<Coefficient, Dimensionless>, Factor>>;
+};
+
+template <typename Coefficient, typename Unit>
+struct scaled<Coefficient, NoFactor, Unit>
+{
+    using type = ScalarValue<Coefficient, Unit>;
+};
+
+template <typename Coefficient, typename Factor, typename Unit>
+using scaled_t = typename scaled<Coefficient, Factor, Unit>::type;
+
+template <typename Lhs, typename Rhs>
+struct ordered_product
+{
+    using type = std::conditional_t<type_precedes<Rhs, Lhs>, Multiply<Rhs, Lhs>, Multiply<Lhs, Rhs>>;
+};
+
+template <typename Lhs>
+struct ordered_product<Lhs, NoFactor>
+{
+    using type = Lhs;
+};
+
+template <typename Rhs>
+struct ordered_product<NoFactor, Rhs>
+{
+    using type = Rhs;
+};
+
+template <>
+struct ordered_product<NoFactor, NoFactor>
+{
+    using type = NoFactor;
+};
+
+// Coefficients are merged where that saves a multiplication; a single one
+// stays with its factor, which other expressions may share.
+template <typename Lhs, typename Rhs, typename Unit>
+struct product
+{
+    using LhsSplit = scaled_split<Lhs>;
+    using RhsSplit = scaled_split<Rhs>;
+    using Coefficient = std::ratio_multiply<typename LhsSplit::Coefficient, typename RhsSplit::Coefficient>;
+    constexpr static bool merge =
+        std::is_same_v<typename LhsSplit::Factor, NoFactor> || std::is_same_v<typename RhsSplit::Factor, NoFactor> ||
+        (!std::ratio_equal_v<typename LhsSplit::Coefficient, std::ratio<1>> && !std::ratio_equal_v<typename RhsSplit::Coefficient, std::ratio<1>>);
+    using type = std::conditional_t<
+        merge, scaled_t<Coefficient, typename ordered_product<typename LhsSplit::Factor, typename RhsSplit::Factor>::type, Unit>,
+        typename ordered_product<Lhs, Rhs>::type>;
+};
+
+template <typename Lhs, typename Rhs, typename Unit> requires ZeroConstant<Lhs> || ZeroConstant<Rhs>
+struct product<Lhs, Rhs, Unit>
+{
+    using type = ScalarValue<std::ratio<0>, Unit>;
+};
+
+template <NonZeroConstant Lhs, NonZeroConstant Rhs, typename Unit>
+struct product<Lhs, Rhs, Unit>
+{
+    using type = ScalarValue<std::ratio_multiply<typename constant_of<Lhs>::ratio, typename constant_of<Rhs>::ratio>, Unit>;
+};
+
+template <typename Lhs, typename Rhs, typename Unit>
+struct quotient
+{
+    using type = Divide<Lhs, Rhs>;
+};
+
+template <typename Lhs, OneConstant Rhs, typename Unit> requires(!ConstantExpression<Lhs>)
+struct quotient<Lhs, Rhs, Unit>
+{
+    using type = Lhs;
+};
+
+template <ZeroConstant Lhs, typename Rhs, typename Unit> requires(!ConstantExpression<Rhs>)
+struct quotient<Lhs, Rhs, Unit>
+{
+    using type = ScalarValue<std::ratio<0>, Unit>;
+};
+
+template <ConstantExpression Lhs, NonZeroConstant Rhs, typename Unit>
+struct quotient<Lhs, Rhs, Unit>
+{
+    using type = ScalarValue<std::ratio_divide<typename constant_of<Lhs>::ratio, typename constant_of<Rhs>::ratio>, Unit>;
+};
+
+// one term of a sum, Coefficient * Factor
+template <typename Coefficient_, typename Factor_>
+struct Term
+{
+    using Coefficient = Coefficient_;
+    using Factor = Factor_;
+};
+
+// terms of a simplified expression as a summand with Sign; constants of
+// the sum have NoFactor
+template <typename Expression, typename Sign>
+struct sum_terms
+{
+    using Split = scaled_split<Expression>;
+    using type = std::tuple<Term<std::ratio_multiply<Sign, typename Split::Coefficient>, typename Split::Factor>>;
+};
+
+template <typename value_, typename Unit_, typename Sign>
+struct sum_terms<ScalarValue<value_, Unit_>, Sign>
+{
+    using type = std::tuple<Term<std::ratio_multiply<Sign, typename value_::type>, NoFactor>>;
+};
+
+template <typename Lhs, typename Rhs, typename Sign>
+struct sum_terms<Add<Lhs, Rhs>, Sign>
+{
+    using type = tuple_cat_t<typename sum_terms<Lhs, Sign>::type, typename sum_terms<Rhs, Sign>::type>;
+};
+
+template <typename Lhs, typename Rhs, typename Sign>
+struct sum_terms<Substract<Lhs, Rhs>, Sign>
+{
+    using type = tuple_cat_t<typename sum_terms<Lhs, Sign>::type,
+                             typename sum_terms<Rhs, std::ratio_multiply<Sign, std::ratio<-1>>>::type>;
+};
+
+template <typename... Ratios>
+struct ratio_sum
+{
+    using type = std::ratio<0>;
+};
+
+template <typename First, typename... Rest>
+struct ratio_sum<First, Rest...>
+{
+    using type = std::ratio_add<First, typename ratio_sum<Rest...>::type>;
+};
+
+// sum of the coefficients of all terms with Factor
+template <typename Factor, typename... Terms>
+using collected_t = typename ratio_sum<
+    std::conditional_t<std::is_same_v<Factor, typename Terms::Factor>, typename Terms::Coefficient, std::ratio<0>>...>::type;
+
+template <typename Terms, typename Indices = std::make_index_sequence<std::tuple_size_v<Terms>>>
+struct sorted_terms;
+
+template <>
+struct sorted_terms<std::tuple<>, std::index_sequence<>>
+{
+    using type = std::tuple<>;
+};
+
+template <typename... Terms, std::size_t... idx>
+struct sorted_terms<std::tuple<Terms...>, std::index_sequence<idx...>>
+{
+    template <std::size_t lhs>
+    constexpr static std::array<bool, sizeof...(Terms)> precedes{
+        type_precedes<typename std::tuple_element_t<lhs, std::tuple<Terms...>>::Factor, typename Terms::Factor>...};
+
+    constexpr static auto order = []() {
+        constexpr std::array<std::array<bool, sizeof...(Terms)>, sizeof...(Terms)> before{precedes<idx>...};
+        std::array<std::size_t, sizeof...(Terms)> result{idx...};
+        std::ranges::sort(result, [&before](std::size_t lhs, std::size_t rhs) { return before[lhs][rhs]; });
+        return result;
+    }();
+    using type = std::tuple<std::tuple_element_t<order[idx], std::tuple<Terms...>>...>;
+};
+
+template <typename Factors, typename... Terms>
+struct like_terms;
+
+// the terms with nonzero collected coefficients, split by sign into sorted
+// terms with positive coefficients, and the constant
+template <typename... Factors, typename... Terms>
+struct like_terms<std::tuple<Factors...>, Terms...>
+{
+    using Constant = collected_t<NoFactor, Terms...>;
+
+    template <bool negative>
+    using signed_terms = typename sorted_terms<tuple_cat_t<std::conditional_t<
+        !std::is_same_v<Factors, NoFactor> && (negative ? collected_t<Factors, Terms...>::num < 0 : collected_t<Factors, Terms...>::num > 0),
+        std::tuple<Term<std::ratio<(negative ? -1 : 1) * collected_t<Factors, Terms...>::num, collected_t<Factors, Terms...>::den>, Factors>>,
+        std::tuple<>>...>>::type;
+
+    using Positive = signed_terms<false>;
+    using Negative = signed_terms<true>;
+};
+
+template <typename Terms>
+struct collect;
+
+template <typename... Terms>
+struct collect<std::tuple<Terms...>> : like_terms<to_unique_tuple_t<std::tuple<typename Terms::Factor...>>, Terms...>
+{
+};
+
+template <typename Head, typename Terms, bool subtract>
+struct fold_terms
+{
+    using type = Head;
+};
+
+template <typename Head, typename First, typename... Rest, bool subtract>
+struct fold_terms<Head, std::tuple<First, Rest...>, subtract>
+{
+    using Operand = scaled_t<typename First::Coefficient, typename First::Factor, typename Head::Unit>;
+    using type = typename fold_terms<std::conditional_t<subtract, Substract<Head, Operand>, Add<Head, Operand>>,
+                                     std::tuple<Rest...>, subtract>::type;
+};
+
+template <typename Head, typename Constant>
+using with_constant_t = std::conditional_t<
+    (Constant::num > 0), Add<Head, ScalarValue<Constant, typename Head::Unit>>,
+    std::conditional_t<(Constant::num < 0), Substract<Head, ScalarValue<std::ratio<-Constant::num, Constant::den>, typename Head::Unit>>,
+                       Head>>;
+
+// positive terms, then the negative ones subtracted, then the constant
+template <typename Positive, typename Negative, typename Constant, typename Unit>
+struct build_sum;
+
+template <typename First, typename... Positive, typename Negative, typename Constant, typename Unit>
+struct build_sum<std::tuple<First, Positive...>, Negative, Constant, Unit>
+{
+    using Head = scaled_t<typename First::Coefficient, typename First::Factor, Unit>;
+    using type = with_constant_t<
+        typename fold_terms<typename fold_terms<Head, std::tuple<Positive...>, false>::type, Negative, true>::type, Constant>;
+};
+
+template <typename First, typename... Negative, typename Constant, typename Unit>
+struct build_sum<std::tuple<>, std::tuple<First, Negative...>, Constant, Unit>
+{
+    using Head = std::conditional_t<
+        (Constant::num > 0), ScalarValue<Constant, Unit>,
+        scaled_t<std::ratio<-First::Coefficient::num, First::Coefficient::den>, typename First::Factor, Unit>>;
+    using type = std::conditional_t<
+        (Constant::num > 0), typename fold_terms<Head, std::tuple<First, Negative...>, true>::type,
+        with_constant_t<typename fold_terms<Head, std::tuple<Negative...>, true>::type, Constant>>;
+};
+
+template <typename Constant, typename Unit>
+struct build_sum<std::tuple<>, std::tuple<>, Constant, Unit>
+{
+    using type = ScalarValue<Constant, Unit>;
+};
+
+template <typename Expression>
+struct simplified_sum
+{
+    using Terms = collect<typename sum_terms<Expression, std::ratio<1>>::type>;
+    using type = typename build_sum<typename Terms::Positive, typename Terms::Negative, typename Terms::Constant,
+                                   typename Expression::Unit>::type;
+};
+
+template <template <typename, typename> typename Node, typename Lhs, typename Rhs>
+struct commutative
+{
+    using type = std::conditional_t<type_precedes<Rhs, Lhs>, Node<Rhs, Lhs>, Node<Lhs, Rhs>>;
+};
+
+template <template <typename, typename> typename Node, typename Operand>
+struct commutative<Node, Operand, Operand>
+{
+    using type = Operand;
+};
+
+} // namespace detail
+
+template <typename Lhs, typename Rhs>
+struct simplify<Add<Lhs, Rhs>>
+{
+    using Node = Add<simplify_t<Lhs>, simplify_t<Rhs>>;
+    using type = detail::guarded_t<Node, typename detail::simplified_sum<Node>::type>;
+};
+
+template <typename Lhs, typename Rhs>
+struct simplify<Substract<Lhs, Rhs>>
+{
+    using Node = Substract<simplify_t<Lhs>, simplify_t<Rhs>>;
+    using type = detail::guarded_t<Node, typename detail::simplified_sum<Node>::type>;
+};
+
+template <typename Lhs, typename Rhs>
+struct simplify<Multiply<Lhs, Rhs>>
+{
+    using Node = Multiply<simplify_t<Lhs>, simplify_t<Rhs>>;
+    using type = detail::guarded_t<Node, typename detail::product<simplify_t<Lhs>, simplify_t<Rhs>, typename Node::Unit>::type>;
+};
+
+template <typename Lhs, typename Rhs>
+struct simplify<Divide<Lhs, Rhs>>
+{
+    using Node = Divide<simplify_t<Lhs>, simplify_t<Rhs>>;
+    using type = detail::guarded_t<Node, typename detail::quotient<simplify_t<Lhs>, simplify_t<Rhs>, typename Node::Unit>::type>;
+};
+
+// contracted again by schedule
+template <typename Lhs, typename Rhs, typename Addend>
+struct simplify<FusedMultiplyAdd<Lhs, Rhs, Addend>>
+{
+    using type = simplify_t<Add<Multiply<Lhs, Rhs>, Addend>>;
+};
+
+template <typename Lhs>
+struct simplify<Sinus<Lhs>>
+{
+    using type = Sinus<simplify_t<Lhs>>;
+};
+
+template <typename Lhs>
+struct simplify<Cosinus<Lhs>>
+{
+    using type = Cosinus<simplify_t<Lhs>>;
+};
+
+template <typename Lhs>
+struct simplify<Sum<Lhs>>
+{
+    using type = Sum<simplify_t<Lhs>>;
+};
+
+template <typename Lhs, typename Rhs>
+struct simplify<Min<Lhs, Rhs>>
+{
+    using Node = Min<simplify_t<Lhs>, simplify_t<Rhs>>;
+    using type = detail::guarded_t<Node, typename detail::commutative<Min, simplify_t<Lhs>, simplify_t<Rhs>>::type>;
+};
+
+template <typename Lhs, typename Rhs>
+struct simplify<Max<Lhs, Rhs>>
+{
+    using Node = Max<simplify_t<Lhs>, simplify_t<Rhs>>;
+    using type = detail::guarded_t<Node, typename detail::commutative<Max, simplify_t<Lhs>, simplify_t<Rhs>>::type>;
+};
+
+template <typename Lhs, typename Rhs>
+struct simplify<Less<Lhs, Rhs>>
+{
+    using type = Less<simplify_t<Lhs>, simplify_t<Rhs>>;
+};
+
+template <typename Condition, typename OnTrue, typename OnFalse>
+struct simplify<Select<Condition, OnTrue, OnFalse>>
+{
+    using Node = Select<simplify_t<Condition>, simplify_t<OnTrue>, simplify_t<OnFalse>>;
+    using type = detail::guarded_t<
+        Node, std::conditional_t<std::is_same_v<simplify_t<OnTrue>, simplify_t<OnFalse>>, simplify_t<OnTrue>, Node>>;
+};
+
+template <typename Table, typename... Arguments>
+struct simplify<Lookup<Table, Arguments...>>
+{
+    using type = Lookup<Table, simplify_t<Arguments>...>;
+};
+
+template <typename Operand, typename Expression>
+struct simplify<Derivative<Operand, Expression>>
+{
+    using type = Derivative<Operand, simplify_t<Expression>>;
+};
+
+} // namespace codys
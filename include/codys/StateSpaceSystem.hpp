@@ -2,6 +2,7 @@
 
 #include <codys/Concepts.hpp>
 #include <codys/Derivative.hpp>
+#include <codys/Schedule.hpp>
 #include <codys/tuple_utilities.hpp>
 
 #include <array>
@@ -58,7 +59,7 @@ concept has_idx_of = requires(System)
 };
 
 template<class T, typename System> requires has_idx_of<System, T>
-static constexpr auto get_idx()
+constexpr auto get_idx()
 {
     return System::template idx_of<T>();
 }
@@ -120,28 +121,51 @@ template <TypeIndexedList SystemType, TypeIndexedList ControlsType, DerivativeSy
 struct StateSpaceSystem
 {
     using AllStates = tuple_cat_t<SystemType, ControlsType>;
-    constexpr static auto stateSize = std::tuple_size_v<SystemType>;
-    constexpr static auto derivativeFunctions = StateSpaceType::make_dot();
+    constexpr static auto stateSize = slot_count_v<SystemType>;
+    constexpr static auto derivativeFunctions = evaluated_derivatives(StateSpaceType::make_dot());
     constexpr static std::size_t derivativeFunctionsSize = std::tuple_size<
         decltype(derivativeFunctions)>{};
-    constexpr static auto controlSize = std::tuple_size_v<ControlsType>;
+    constexpr static auto controlSize = slot_count_v<ControlsType>;
 
     constexpr static void evaluate(
         std::span<const double, stateSize + controlSize> statesIn,
         std::span<double, stateSize> derivativesOut)
     {
-        detail::tuple_for_each(derivativeFunctions,
-                            [statesIn, derivativesOut]<typename DerivativeType>(DerivativeType derivative) {
-                                constexpr auto outIdx = get_idx<typename DerivativeType::Operand, SystemType>();
-                                derivativesOut[outIdx] = derivative.template evaluate<AllStates>(statesIn);
-                            }
-        );
-        
+        evaluate_equations(std::make_index_sequence<derivativeFunctionsSize>{},
+                           statesIn, derivativesOut);
+    }
+
+    template <std::size_t equationIdx>
+    constexpr static void evaluate_equation(
+        std::span<const double, stateSize + controlSize> statesIn,
+        std::span<double, stateSize> derivativesOut)
+    {
+        using DerivativeType = std::tuple_element_t<equationIdx, std::remove_cvref_t<decltype(derivativeFunctions)>>;
+        constexpr auto outIdx = get_offset<typename DerivativeType::Operand, SystemType>();
+        if constexpr (DerivativeType::extent == 1) {
+            derivativesOut[outIdx] = DerivativeType::template evaluate<AllStates>(statesIn);
+        } else {
+            // one tight loop over all elements, which the compiler can vectorize
+            for (std::size_t element = 0; element < DerivativeType::extent; ++element) {
+                derivativesOut[outIdx + element] = DerivativeType::template evaluate<AllStates>(statesIn, element);
+            }
+        }
+    }
+
+    template <std::size_t... equationIdx>
+    constexpr static void evaluate_equations(
+        std::index_sequence<equationIdx...> /*equations*/,
+        std::span<const double, stateSize + controlSize> statesIn,
+        std::span<double, stateSize> derivativesOut)
+    {
+        (evaluate_equation<equationIdx>(statesIn, derivativesOut), ...);
     }
 
     static std::string format_values(
         std::span<const double, stateSize + controlSize> statesIn)
     {
+        static_assert(stateSize + controlSize == std::tuple_size_v<AllStates>,
+                      "format_values formats one value per quantity and does not support QuantityArray");
         std::array<double, stateSize> derivativeValuesOut{};
         std::ranges::fill(derivativeValuesOut, 0.0);
         evaluate(statesIn, derivativeValuesOut);
@@ -229,7 +253,7 @@ constexpr auto expression_of_v = expression_of<T, Derivatives>::value();
 template <typename... Expression>
 constexpr auto combineExpressions(std::tuple<Expression...> expr)
 {
-    return (std::get<Expression>(expr) + ...);
+    return std::apply([](auto... expression) { return (expression + ...); }, expr);
 }
 
 template <typename Operand, typename... DerivativeSystem>
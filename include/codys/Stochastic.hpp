@@ -0,0 +1,246 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Integrator.hpp>
+#include <codys/Jacobian.hpp>
+
+#include <units/isq/si/time.h>
+#include <units/math.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+namespace detail
+{
+
+template <class Unit>
+using diffusion_in_time_t = decltype(std::declval<Unit>() / units::sqrt(units::isq::si::time<units::isq::si::second>{}));
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+constexpr std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key)
+{
+    constexpr std::uint64_t multiplier0 = 0xD2511F53;
+    constexpr std::uint64_t multiplier1 = 0xCD9E8D57;
+    constexpr std::uint32_t weyl0 = 0x9E3779B9;
+    constexpr std::uint32_t weyl1 = 0xBB67AE85;
+    for (std::size_t round = 0; round < 10; ++round) {
+        const auto product0 = multiplier0 * counter[0];
+        const auto product1 = multiplier1 * counter[2];
+        counter = {static_cast<std::uint32_t>(product1 >> 32U) ^ counter[1] ^ key[0],
+                   static_cast<std::uint32_t>(product1),
+                   static_cast<std::uint32_t>(product0 >> 32U) ^ counter[3] ^ key[1],
+                   static_cast<std::uint32_t>(product0)};
+        key[0] += weyl0;
+        key[1] += weyl1;
+    }
+    return counter;
+}
+
+// uniform in (0, 1) from 53 bits
+constexpr double open_unit_interval(std::uint32_t high, std::uint32_t low)
+{
+    const auto bits = ((static_cast<std::uint64_t>(high) << 32U) | low) >> 11U;
+    return (static_cast<double>(bits) + 0.5) / 9007199254740992.0;
+}
+
+} // namespace detail
+
+// N standard normal variates of `step` of `trajectory`: the same numbers for
+// the same keys on any thread and in any order. The Philox blocks and the
+// Box-Muller transform run as two separate loops over the whole block, so
+// both vectorize.
+template <std::size_t N>
+void standard_normals(std::uint64_t trajectory, std::uint64_t step, std::span<double, N> out)
+{
+    constexpr std::size_t pairs = (N + 1) / 2;
+    const std::array<std::uint32_t, 2> key{static_cast<std::uint32_t>(trajectory), static_cast<std::uint32_t>(trajectory >> 32U)};
+
+    std::array<std::array<std::uint32_t, 4>, pairs> bits{};
+    for (std::size_t pair = 0; pair < pairs; ++pair) {
+        bits[pair] = detail::philox4x32(
+            {static_cast<std::uint32_t>(pair), 0, static_cast<std::uint32_t>(step), static_cast<std::uint32_t>(step >> 32U)}, key);
+    }
+
+    std::array<double, 2 * pairs> normals{};
+    for (std::size_t pair = 0; pair < pairs; ++pair) {
+        const double radius = std::sqrt(-2.0 * std::log(detail::open_unit_interval(bits[pair][0], bits[pair][1])));
+        const double angle = 2.0 * std::numbers::pi * detail::open_unit_interval(bits[pair][2], bits[pair][3]);
+        normals[2 * pair] = radius * std::cos(angle);
+        normals[2 * pair + 1] = radius * std::sin(angle);
+    }
+    std::copy_n(normals.begin(), N, out.begin());
+}
+
+// g(x, u) in dx = f(x, u) dt + g(x, u) dW, for the slots of Operand
+template <PhysicalType Operand_, typename Expression_>
+struct Diffusion
+{
+    using Operand = Operand_;
+    using Expression = Expression_;
+    using Unit = detail::diffusion_in_time_t<typename Operand::Unit>;
+    constexpr static std::size_t extent = extent_v<Operand>;
+
+    static_assert(std::is_same_v<typename Expression::Unit, Unit>,
+                  "diffusion must have the unit of the state per square root of time");
+    static_assert(compatible_extents<Operand, Expression>,
+                  "expression of an array diffusion must be scalar or of the operand's extent");
+};
+
+template <PhysicalType StateName, class Expression>
+constexpr auto noise(Expression /*expression*/)
+{
+    return Diffusion<StateName, Expression>{};
+}
+
+// System with diagonal noise: one independent Wiener process per slot of
+// every state named in NoiseSpec::make_noise(), declared next to make_dot.
+// The diffusion expressions may read any quantity of System.
+template <typename System, typename NoiseSpec>
+struct StochasticSystem
+{
+    using Drift = System;
+    using AllStates = typename System::AllStates;
+    using Noise = std::remove_cvref_t<decltype(NoiseSpec::make_noise())>;
+    constexpr static std::size_t stateSize = System::stateSize;
+    constexpr static std::size_t controlSize = System::controlSize;
+    constexpr static std::size_t inputSize = stateSize + controlSize;
+    constexpr static std::size_t noiseCount = []<std::size_t... idx>(std::index_sequence<idx...> /*terms*/) {
+        return (std::size_t{0} + ... + std::tuple_element_t<idx, Noise>::extent);
+    }(std::make_index_sequence<std::tuple_size_v<Noise>>{});
+
+    // state slot driven by each Wiener process
+    constexpr static auto noiseSlots = []<std::size_t... idx>(std::index_sequence<idx...> /*terms*/) {
+        std::array<std::size_t, noiseCount> result{};
+        std::size_t next = 0;
+        ([&]<typename DiffusionType>() {
+            constexpr auto offset = get_offset<typename DiffusionType::Operand, AllStates>();
+            static_assert(offset < stateSize, "noise can only drive states");
+            for (std::size_t element = 0; element < DiffusionType::extent; ++element) {
+                result[next++] = offset + element;
+            }
+        }.template operator()<std::tuple_element_t<idx, Noise>>(), ...);
+        return result;
+    }(std::make_index_sequence<std::tuple_size_v<Noise>>{});
+
+    constexpr static void diffusion(std::span<const double, inputSize> statesIn, std::span<double, noiseCount> diffusionOut)
+    {
+        for_each_term([&]<typename DiffusionType>(std::size_t noiseIdx, std::size_t element) {
+            diffusionOut[noiseIdx] = DiffusionType::Expression::template evaluate<AllStates>(statesIn, element);
+        });
+    }
+
+    // d g_k / d x of the slot that process k drives, for Milstein
+    constexpr static void diffusion_slope(std::span<const double, inputSize> statesIn, std::span<double, noiseCount> slopeOut)
+    {
+        for_each_term([&]<typename DiffusionType>(std::size_t noiseIdx, std::size_t element) {
+            slopeOut[noiseIdx] = detail::forward_node<typename DiffusionType::Expression>::template evaluate<AllStates>(
+                                     statesIn, element, noiseSlots[noiseIdx]).derivative;
+        });
+    }
+
+private:
+    template <typename Func>
+    constexpr static void for_each_term(Func&& func)
+    {
+        [&]<std::size_t... idx>(std::index_sequence<idx...> /*terms*/) {
+            std::size_t noiseIdx = 0;
+            ([&]<typename DiffusionType>() {
+                for (std::size_t element = 0; element < DiffusionType::extent; ++element) {
+                    func.template operator()<DiffusionType>(noiseIdx++, element);
+                }
+            }.template operator()<std::tuple_element_t<idx, Noise>>(), ...);
+        }(std::make_index_sequence<std::tuple_size_v<Noise>>{});
+    }
+};
+
+// One step of an SDE with the Wiener increments dW of the step, strong order 1/2.
+struct EulerMaruyama
+{
+    template <typename Sde>
+    constexpr static void step(
+        std::span<double, Sde::stateSize> states,
+        std::span<const double, Sde::controlSize> controls,
+        double dt,
+        std::span<const double, Sde::noiseCount> dW)
+    {
+        std::array<double, Sde::inputSize> in{};
+        std::ranges::copy(states, in.begin());
+        std::ranges::copy(controls, in.begin() + Sde::stateSize);
+        std::array<double, Sde::stateSize> drift{};
+        std::array<double, Sde::noiseCount> diffusion{};
+        Sde::Drift::evaluate(in, drift);
+        Sde::diffusion(in, diffusion);
+        for (std::size_t i = 0; i < Sde::stateSize; ++i) {
+            states[i] += dt * drift[i];
+        }
+        for (std::size_t k = 0; k < Sde::noiseCount; ++k) {
+            states[Sde::noiseSlots[k]] += diffusion[k] * dW[k];
+        }
+    }
+};
+
+// Euler-Maruyama with the Milstein correction, strong order 1 for diagonal noise.
+struct Milstein
+{
+    template <typename Sde>
+    constexpr static void step(
+        std::span<double, Sde::stateSize> states,
+        std::span<const double, Sde::controlSize> controls,
+        double dt,
+        std::span<const double, Sde::noiseCount> dW)
+    {
+        std::array<double, Sde::inputSize> in{};
+        std::ranges::copy(states, in.begin());
+        std::ranges::copy(controls, in.begin() + Sde::stateSize);
+        std::array<double, Sde::stateSize> drift{};
+        std::array<double, Sde::noiseCount> diffusion{};
+        std::array<double, Sde::noiseCount> slope{};
+        Sde::Drift::evaluate(in, drift);
+        Sde::diffusion(in, diffusion);
+        Sde::diffusion_slope(in, slope);
+        for (std::size_t i = 0; i < Sde::stateSize; ++i) {
+            states[i] += dt * drift[i];
+        }
+        for (std::size_t k = 0; k < Sde::noiseCount; ++k) {
+            states[Sde::noiseSlots[k]] += diffusion[k] * dW[k] + 0.5 * diffusion[k] * slope[k] * (dW[k] * dW[k] - dt);
+        }
+    }
+};
+
+// Integrates `stepCount` steps of trajectory `trajectory`, starting at step
+// index `firstStep`. The increments of each step are drawn from the
+// counter-based generator keyed by (trajectory, step), so an ensemble gives
+// the same paths however its trajectories are split across threads, and a
+// trajectory can be continued by passing the next firstStep.
+template <typename Sde, typename Scheme = EulerMaruyama>
+void integrate_sde(
+    std::span<double, Sde::stateSize> states,
+    std::span<const double, Sde::controlSize> controls,
+    double dt,
+    std::uint64_t stepCount,
+    std::uint64_t trajectory,
+    std::uint64_t firstStep = 0)
+{
+    const double scale = std::sqrt(dt);
+    std::array<double, Sde::noiseCount> dW{};
+    for (std::uint64_t step = firstStep; step < firstStep + stepCount; ++step) {
+        standard_normals<Sde::noiseCount>(trajectory, step, dW);
+        for (auto& increment : dW) {
+            increment *= scale;
+        }
+        Scheme::template step<Sde>(states, controls, dt, dW);
+    }
+}
+
+} // namespace codys
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Integrator.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+// Splits the equations of System into two groups such that no equation
+// reads a state defined by its own group, as with q' = f(p, u) and
+// p' = g(q, u). The equations are 2-colored on the graph linking an equation
+// to those defining the states it reads; group 0 holds the first equation.
+// Not separable if that graph has an odd cycle, e.g. an equation reading
+// its own state.
+template <typename System>
+struct state_split
+{
+    using Derivatives = std::remove_cvref_t<decltype(System::derivativeFunctions)>;
+    constexpr static std::size_t equationCount = std::tuple_size_v<Derivatives>;
+
+    template <std::size_t eq>
+    using equation_t = std::tuple_element_t<eq, Derivatives>;
+
+    // reads[eq][other]: equation eq reads the state equation other defines
+    constexpr static auto reads = []() {
+        std::array<std::array<bool, equationCount>, equationCount> result{};
+        [&]<std::size_t... eq>(std::index_sequence<eq...> /*equations*/) {
+            ([&]<std::size_t reader>() {
+                [&]<std::size_t... other>(std::index_sequence<other...> /*equations*/) {
+                    ((result[reader][other] =
+                          detail::Contains<typename equation_t<other>::Operand, typename equation_t<reader>::depends_on>::value),
+                     ...);
+                }(std::make_index_sequence<equationCount>{});
+            }.template operator()<eq>(), ...);
+        }(std::make_index_sequence<equationCount>{});
+        return result;
+    }();
+
+    struct Coloring
+    {
+        std::array<std::size_t, equationCount> groupOf{};
+        bool separable{true};
+    };
+
+    constexpr static Coloring coloring = []() {
+        Coloring result{};
+        std::array<bool, equationCount> colored{};
+        std::array<std::size_t, equationCount> queue{};
+        for (std::size_t start = 0; start < equationCount; ++start) {
+            if (colored[start]) {
+                continue;
+            }
+            colored[start] = true;
+            result.groupOf[start] = 0;
+            std::size_t head = 0;
+            std::size_t tail = 0;
+            queue[tail++] = start;
+            while (head < tail) {
+                const auto eq = queue[head++];
+                for (std::size_t other = 0; other < equationCount; ++other) {
+                    if (!reads[eq][other] && !reads[other][eq]) {
+                        continue;
+                    }
+                    if (!colored[other]) {
+                        colored[other] = true;
+                        result.groupOf[other] = 1 - result.groupOf[eq];
+                        queue[tail++] = other;
+                    } else if (result.groupOf[other] == result.groupOf[eq]) {
+                        result.separable = false;
+                    }
+                }
+            }
+        }
+        return result;
+    }();
+
+    constexpr static bool separable = coloring.separable;
+    constexpr static auto groupOf = coloring.groupOf;
+
+    template <std::size_t group>
+    constexpr static auto members = []() {
+        constexpr auto count = static_cast<std::size_t>(std::ranges::count(groupOf, group));
+        std::array<std::size_t, count> result{};
+        std::size_t next = 0;
+        for (std::size_t eq = 0; eq < equationCount; ++eq) {
+            if (groupOf[eq] == group) {
+                result[next++] = eq;
+            }
+        }
+        return result;
+    }();
+};
+
+// derivatives of the states of one group of state_split; those of the
+// other group are left untouched
+template <typename System, std::size_t group>
+constexpr void evaluate_split_group(
+    std::span<const double, System::stateSize + System::controlSize> statesIn,
+    std::span<double, System::stateSize> derivativesOut)
+{
+    using Split = state_split<System>;
+    [statesIn, derivativesOut]<std::size_t... memberIdx>(std::index_sequence<memberIdx...> /*members*/) {
+        System::evaluate_equations(
+            std::index_sequence<Split::template members<group>[memberIdx]...>{},
+            statesIn, derivativesOut);
+    }(std::make_index_sequence<Split::template members<group>.size()>{});
+}
+
+namespace detail
+{
+
+// advances the states of `group` by scale times their derivatives
+template <typename System, std::size_t group>
+constexpr void split_substep(std::span<double, System::stateSize + System::controlSize> in, double scale)
+{
+    using Split = state_split<System>;
+    std::array<double, System::stateSize> derivatives{};
+    evaluate_split_group<System, group>(in, derivatives);
+    [&]<std::size_t... memberIdx>(std::index_sequence<memberIdx...> /*members*/) {
+        ([&]<typename DerivativeType>() {
+            constexpr auto offset = get_offset<typename DerivativeType::Operand, typename System::AllStates>();
+            for (std::size_t element = 0; element < DerivativeType::extent; ++element) {
+                in[offset + element] += scale * derivatives[offset + element];
+            }
+        }.template operator()<typename Split::template equation_t<Split::template members<group>[memberIdx]>>(), ...);
+    }(std::make_index_sequence<Split::template members<group>.size()>{});
+}
+
+template <typename System>
+constexpr void verlet(std::span<double, System::stateSize + System::controlSize> in, double dt)
+{
+    split_substep<System, 1>(in, dt / 2.0);
+    split_substep<System, 0>(in, dt);
+    split_substep<System, 1>(in, dt / 2.0);
+}
+
+} // namespace detail
+
+// Stormer-Verlet for systems with a state_split: a half step of group 1, a
+// full step of group 0 with the new group 1 states, and a half step of group
+// 1. Second order, symplectic for Hamiltonian systems, and every substep
+// evaluates only the equations of the group it advances. Controls are held
+// constant over a step.
+struct StormerVerlet
+{
+    template <typename System>
+    constexpr static void step(
+        std::span<double, System::stateSize> states,
+        std::span<const double, System::controlSize> controls,
+        double dt)
+    {
+        static_assert(state_split<System>::separable, "system has no position/velocity split");
+        std::array<double, System::stateSize + System::controlSize> in{};
+        std::ranges::copy(states, in.begin());
+        std::ranges::copy(controls, in.begin() + System::stateSize);
+        detail::verlet<System>(in, dt);
+        std::copy_n(in.begin(), System::stateSize, states.begin());
+    }
+};
+
+// Fourth order composition of three Stormer-Verlet steps (Yoshida 1990),
+// symplectic like its parts.
+struct Yoshida4
+{
+    template <typename System>
+    constexpr static void step(
+        std::span<double, System::stateSize> states,
+        std::span<const double, System::controlSize> controls,
+        double dt)
+    {
+        static_assert(state_split<System>::separable, "system has no position/velocity split");
+        const double cubeRootOfTwo = std::cbrt(2.0);
+        const double outer = 1.0 / (2.0 - cubeRootOfTwo);
+        const double inner = -cubeRootOfTwo * outer;
+        std::array<double, System::stateSize + System::controlSize> in{};
+        std::ranges::copy(states, in.begin());
+        std::ranges::copy(controls, in.begin() + System::stateSize);
+        detail::verlet<System>(in, outer * dt);
+        detail::verlet<System>(in, inner * dt);
+        detail::verlet<System>(in, outer * dt);
+        std::copy_n(in.begin(), System::stateSize, states.begin());
+    }
+};
+
+} // namespace codys
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <codys/Jacobian.hpp>
+#include <codys/SystemInterface.hpp>
+
+#include <span>
+
+namespace codys
+{
+
+template <typename System>
+constexpr SystemInterface make_system_interface()
+{
+    constexpr auto inputSize = System::stateSize + System::controlSize;
+    return SystemInterface(
+        System::stateSize, System::controlSize,
+        [](const double* statesIn, double* derivativesOut) {
+            System::evaluate(std::span<const double, inputSize>(statesIn, inputSize),
+                             std::span<double, System::stateSize>(derivativesOut, System::stateSize));
+        },
+        [](const double* statesIn, double* jacobianOut) {
+            jacobian<System>(std::span<const double, inputSize>(statesIn, inputSize),
+                             std::span<double, System::stateSize * inputSize>(jacobianOut, System::stateSize * inputSize));
+        },
+        []() { return System::format(); });
+}
+
+} // namespace codys
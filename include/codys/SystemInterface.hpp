@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+namespace codys
+{
+
+// Non-template handle to one StateSpaceSystem. Instantiate the system once
+// with make_system_interface (SystemInstance.hpp) and hand out only this
+// handle, so that consumers neither include nor instantiate the expression
+// templates of the model:
+//
+//   // motion.hpp
+//   const codys::SystemInterface& motion();
+//
+//   // motion.cpp, the only translation unit that includes the model
+//   const codys::SystemInterface& motion()
+//   {
+//       constexpr static auto instance = codys::make_system_interface<codys::StateSpaceSystemOf<Motion>>();
+//       return instance;
+//   }
+class SystemInterface
+{
+public:
+    using EvaluateFunction = void (*)(const double* statesIn, double* out);
+    using FormatFunction = std::string (*)();
+
+    constexpr SystemInterface(std::size_t stateSize, std::size_t controlSize, EvaluateFunction evaluateFunction,
+                              EvaluateFunction jacobianFunction, FormatFunction formatFunction)
+        : stateSize_(stateSize),
+          controlSize_(controlSize),
+          evaluate_(evaluateFunction),
+          jacobian_(jacobianFunction),
+          format_(formatFunction)
+    {
+    }
+
+    [[nodiscard]] constexpr std::size_t stateSize() const { return stateSize_; }
+    [[nodiscard]] constexpr std::size_t controlSize() const { return controlSize_; }
+    [[nodiscard]] constexpr std::size_t inputSize() const { return stateSize_ + controlSize_; }
+
+    // statesIn holds inputSize() values, derivativesOut stateSize()
+    void evaluate(std::span<const double> statesIn, std::span<double> derivativesOut) const
+    {
+        check_size(statesIn.size(), inputSize(), "statesIn");
+        check_size(derivativesOut.size(), stateSize(), "derivativesOut");
+        evaluate_(statesIn.data(), derivativesOut.data());
+    }
+
+    // jacobianOut holds stateSize() x inputSize() values, row-major
+    void jacobian(std::span<const double> statesIn, std::span<double> jacobianOut) const
+    {
+        check_size(statesIn.size(), inputSize(), "statesIn");
+        check_size(jacobianOut.size(), stateSize() * inputSize(), "jacobianOut");
+        jacobian_(statesIn.data(), jacobianOut.data());
+    }
+
+    [[nodiscard]] std::string format() const
+    {
+        return format_();
+    }
+
+private:
+    static void check_size(std::size_t size, std::size_t expected, const char* name)
+    {
+        if (size != expected) {
+            throw std::invalid_argument(std::string(name) + " holds " + std::to_string(size) + " values instead of " +
+                                        std::to_string(expected));
+        }
+    }
+
+    std::size_t stateSize_;
+    std::size_t controlSize_;
+    EvaluateFunction evaluate_;
+    EvaluateFunction jacobian_;
+    FormatFunction format_;
+};
+
+} // namespace codys
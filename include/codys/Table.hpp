@@ -0,0 +1,363 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Operators.hpp>
+#include <codys/tuple_utilities.hpp>
+
+#include <fmt/compile.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace codys
+{
+
+enum class Interpolation
+{
+    Linear,
+    Cubic, // cubic Hermite with slopes from the neighbouring points
+};
+
+namespace detail
+{
+
+// the points of one axis a lookup combines, with their weights for the
+// value and for the derivative along the axis
+struct AxisWeights
+{
+    std::array<std::size_t, 4> index{};
+    std::array<double, 4> value{};
+    std::array<double, 4> slope{};
+};
+
+template <Interpolation interpolation>
+constexpr std::size_t interpolation_points = interpolation == Interpolation::Linear ? 2 : 4;
+
+} // namespace detail
+
+// Values on the tensor grid of D strictly increasing axes, row-major with
+// the last axis contiguous, so the points of one cell lie in runs along it.
+// Views the axes and values, which may be constexpr arrays or a mapped
+// file (see load_table). Uniform axes are detected on construction and
+// indexed in O(1), others by binary search. Lookups outside the grid are
+// clamped to its boundary.
+template <std::size_t D>
+class TableGrid
+{
+public:
+    static_assert(D >= 1);
+
+    constexpr TableGrid(std::array<std::span<const double>, D> axes, std::span<const double> values)
+        : axes_(axes), values_(values)
+    {
+        std::size_t size = 1;
+        for (std::size_t dim = D; dim-- > 0;) {
+            const auto axis = axes_[dim];
+            if (axis.size() < 2) {
+                throw std::invalid_argument("table axis needs at least two points");
+            }
+            for (std::size_t point = 1; point < axis.size(); ++point) {
+                if (!(axis[point] > axis[point - 1])) {
+                    throw std::invalid_argument("table axis must be strictly increasing");
+                }
+            }
+            const double spacing = (axis.back() - axis.front()) / static_cast<double>(axis.size() - 1);
+            bool uniform = true;
+            for (std::size_t point = 0; point < axis.size(); ++point) {
+                const double expected = axis.front() + static_cast<double>(point) * spacing;
+                const double deviation = axis[point] > expected ? axis[point] - expected : expected - axis[point];
+                uniform = uniform && deviation <= 1e-9 * spacing;
+            }
+            spacing_[dim] = uniform ? spacing : 0.0;
+            strides_[dim] = size;
+            size *= axis.size();
+        }
+        if (values_.size() != size) {
+            throw std::invalid_argument("table values do not match the size of the axes");
+        }
+    }
+
+    [[nodiscard]] constexpr std::span<const double> axis(std::size_t dim) const { return axes_[dim]; }
+    [[nodiscard]] constexpr std::span<const double> values() const { return values_; }
+    [[nodiscard]] constexpr bool uniform(std::size_t dim) const { return spacing_[dim] != 0.0; }
+
+    template <Interpolation interpolation>
+    [[nodiscard]] constexpr double evaluate(const std::array<double, D>& at) const
+    {
+        return contract<interpolation>(weights<interpolation>(at), D);
+    }
+
+    // derivative of the interpolant along axis `dim`
+    template <Interpolation interpolation>
+    [[nodiscard]] constexpr double partial(const std::array<double, D>& at, std::size_t dim) const
+    {
+        return contract<interpolation>(weights<interpolation>(at), dim);
+    }
+
+    // out[lane] = evaluate({at[0][lane], ...}). All lanes of a block are
+    // located and weighted before their values are gathered, which keeps
+    // the per-lane arithmetic in straight loops the compiler vectorizes.
+    template <Interpolation interpolation>
+    void evaluate_batch(const std::array<std::span<const double>, D>& at, std::span<double> out) const
+    {
+        constexpr std::size_t lanes = 8;
+        std::array<std::array<detail::AxisWeights, D>, lanes> block{};
+        for (std::size_t first = 0; first < out.size(); first += lanes) {
+            const auto count = std::min(lanes, out.size() - first);
+            for (std::size_t dim = 0; dim < D; ++dim) {
+                for (std::size_t lane = 0; lane < count; ++lane) {
+                    block[lane][dim] = axis_weights<interpolation>(dim, at[dim][first + lane]);
+                }
+            }
+            for (std::size_t lane = 0; lane < count; ++lane) {
+                out[first + lane] = contract<interpolation>(block[lane], D);
+            }
+        }
+    }
+
+private:
+    template <Interpolation interpolation>
+    [[nodiscard]] constexpr std::array<detail::AxisWeights, D> weights(const std::array<double, D>& at) const
+    {
+        std::array<detail::AxisWeights, D> result{};
+        for (std::size_t dim = 0; dim < D; ++dim) {
+            result[dim] = axis_weights<interpolation>(dim, at[dim]);
+        }
+        return result;
+    }
+
+    template <Interpolation interpolation>
+    [[nodiscard]] constexpr detail::AxisWeights axis_weights(std::size_t dim, double x) const
+    {
+        const auto axis = axes_[dim];
+        const auto last = axis.size() - 1;
+        std::size_t cell = 0;
+        if (uniform(dim)) {
+            // clamped before the conversion, which is undefined for NaN and far-out values
+            const double position = (x - axis.front()) / spacing_[dim];
+            const double lastCell = static_cast<double>(last - 1);
+            cell = position > 0.0 ? static_cast<std::size_t>(std::min(position, lastCell)) : 0;
+        } else {
+            cell = static_cast<std::size_t>(std::upper_bound(axis.begin() + 1, axis.end() - 1, x) - axis.begin()) - 1;
+        }
+        const double h = axis[cell + 1] - axis[cell];
+        const bool inside = x >= axis.front() && x <= axis.back();
+        const double theta = std::clamp((x - axis[cell]) / h, 0.0, 1.0);
+        // derivatives are zero where the lookup is clamped
+        const double slopeScale = inside ? 1.0 / h : 0.0;
+
+        detail::AxisWeights result{};
+        if constexpr (interpolation == Interpolation::Linear) {
+            result.index = {cell, cell + 1, cell, cell};
+            result.value = {1.0 - theta, theta, 0.0, 0.0};
+            result.slope = {-slopeScale, slopeScale, 0.0, 0.0};
+        } else {
+            const auto before = cell == 0 ? cell : cell - 1;
+            const auto after = cell + 1 == last ? last : cell + 2;
+            result.index = {before, cell, cell + 1, after};
+
+            const double theta2 = theta * theta;
+            const double theta3 = theta2 * theta;
+            const std::array<double, 4> basis{2.0 * theta3 - 3.0 * theta2 + 1.0, -2.0 * theta3 + 3.0 * theta2,
+                                              theta3 - 2.0 * theta2 + theta, theta3 - theta2};
+            const std::array<double, 4> basisSlope{6.0 * theta2 - 6.0 * theta, -6.0 * theta2 + 6.0 * theta,
+                                                   3.0 * theta2 - 4.0 * theta + 1.0, 3.0 * theta2 - 2.0 * theta};
+            // slopes at both ends of the cell as differences over their neighbours
+            const double startSpan = h / (axis[cell + 1] - axis[before]);
+            const double endSpan = h / (axis[after] - axis[cell]);
+            const auto weigh = [&](const std::array<double, 4>& b, double scale, std::array<double, 4>& w) {
+                w[1] = scale * (b[0] - b[3] * endSpan);
+                w[2] = scale * (b[1] + b[2] * startSpan);
+                w[0] = -scale * b[2] * startSpan;
+                w[3] = scale * b[3] * endSpan;
+            };
+            weigh(basis, 1.0, result.value);
+            weigh(basisSlope, slopeScale, result.slope);
+        }
+        return result;
+    }
+
+    // sum over the cell points of the value weights, using the slope
+    // weights along `derivativeDim` (D for the value itself)
+    template <Interpolation interpolation, std::size_t dim = 0>
+    [[nodiscard]] constexpr double contract(const std::array<detail::AxisWeights, D>& w, std::size_t derivativeDim,
+                                            std::size_t offset = 0) const
+    {
+        if constexpr (dim == D) {
+            return values_[offset];
+        } else {
+            const auto& axisWeights = w[dim];
+            const auto& weight = dim == derivativeDim ? axisWeights.slope : axisWeights.value;
+            double result = 0.0;
+            for (std::size_t point = 0; point < detail::interpolation_points<interpolation>; ++point) {
+                result += weight[point] *
+                          contract<interpolation, dim + 1>(w, derivativeDim, offset + axisWeights.index[point] * strides_[dim]);
+            }
+            return result;
+        }
+    }
+
+    std::array<std::span<const double>, D> axes_;
+    std::span<const double> values_;
+    std::array<std::size_t, D> strides_{};
+    std::array<double, D> spacing_{};
+};
+
+// Binary table layout, in host byte order: the 8 byte magic "codystbl",
+// D as uint64, the size of every axis as uint64, then the axes and the
+// values as doubles. Every field is 8 byte aligned relative to the start.
+constexpr std::string_view table_magic = "codystbl";
+
+// A TableGrid viewing `bytes` (e.g. a file mapped with mmap) without
+// copying; the bytes must outlive the grid and be 8 byte aligned.
+template <std::size_t D>
+TableGrid<D> load_table(std::span<const std::byte> bytes)
+{
+    constexpr std::size_t header = table_magic.size() + sizeof(std::uint64_t) * (D + 1);
+    if (bytes.size() < header || std::memcmp(bytes.data(), table_magic.data(), table_magic.size()) != 0) {
+        throw std::invalid_argument("not a codys table");
+    }
+    if (reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(double) != 0) {
+        throw std::invalid_argument("table data is not aligned");
+    }
+    std::array<std::uint64_t, D + 1> sizes{};
+    std::memcpy(sizes.data(), bytes.data() + table_magic.size(), sizeof(sizes));
+    if (sizes[0] != D) {
+        throw std::invalid_argument("table has a different number of dimensions");
+    }
+    // every count is bounded by the doubles in the file before it is added
+    // or multiplied, so a crafted header cannot wrap around
+    const std::size_t available = (bytes.size() - header) / sizeof(double);
+    std::size_t axisPoints = 0;
+    std::size_t valueCount = 1;
+    for (std::size_t dim = 0; dim < D; ++dim) {
+        const auto size = sizes[dim + 1];
+        if (size > available - axisPoints || (size != 0 && valueCount > available / size)) {
+            throw std::invalid_argument("table size does not match its header");
+        }
+        axisPoints += size;
+        valueCount *= size;
+    }
+    if (bytes.size() != header + sizeof(double) * (axisPoints + valueCount)) {
+        throw std::invalid_argument("table size does not match its header");
+    }
+
+    const auto* data = reinterpret_cast<const double*>(bytes.data() + header);
+    std::array<std::span<const double>, D> axes{};
+    for (std::size_t dim = 0; dim < D; ++dim) {
+        axes[dim] = std::span<const double>(data, sizes[dim + 1]);
+        data += sizes[dim + 1];
+    }
+    return TableGrid<D>(axes, std::span<const double>(data, valueCount));
+}
+
+// the bytes load_table reads, e.g. to write a table file
+template <std::size_t D>
+std::vector<std::byte> table_bytes(const TableGrid<D>& grid)
+{
+    std::vector<std::byte> result;
+    const auto append = [&result](const void* data, std::size_t size) {
+        const auto* first = static_cast<const std::byte*>(data);
+        result.insert(result.end(), first, first + size);
+    };
+    append(table_magic.data(), table_magic.size());
+    const std::uint64_t dimensions = D;
+    append(&dimensions, sizeof(dimensions));
+    for (std::size_t dim = 0; dim < D; ++dim) {
+        const std::uint64_t size = grid.axis(dim).size();
+        append(&size, sizeof(size));
+    }
+    for (std::size_t dim = 0; dim < D; ++dim) {
+        append(grid.axis(dim).data(), grid.axis(dim).size_bytes());
+    }
+    append(grid.values().data(), grid.values().size_bytes());
+    return result;
+}
+
+// A table is a type with the units of its axes and values, the way it is
+// interpolated, its symbol and a static TableGrid `grid`:
+//
+//   struct ThrustMap
+//   {
+//       using AxisUnits = std::tuple<speed_unit, rotation_unit>;
+//       using Unit = force_unit;
+//       constexpr static auto interpolation = codys::Interpolation::Cubic;
+//       constexpr static std::string_view symbol = "T";
+//       inline static const codys::TableGrid<2> grid = codys::load_table<2>(mapped_file());
+//   };
+template <typename Table>
+concept TableType = requires {
+    typename Table::AxisUnits;
+    typename Table::Unit;
+    { Table::interpolation } -> std::convertible_to<Interpolation>;
+    { Table::symbol } -> std::convertible_to<std::string_view>;
+    Table::grid.template evaluate<Table::interpolation>(std::array<double, std::tuple_size_v<typename Table::AxisUnits>>{});
+};
+
+template <TableType Table, typename... Arguments>
+constexpr bool table_arguments_match = []() {
+    if constexpr (sizeof...(Arguments) != std::tuple_size_v<typename Table::AxisUnits>) {
+        return false;
+    } else {
+        return []<std::size_t... idx>(std::index_sequence<idx...> /*axes*/) {
+            return (std::is_same_v<typename Arguments::Unit, std::tuple_element_t<idx, typename Table::AxisUnits>> && ...);
+        }(std::index_sequence_for<Arguments...>{});
+    }
+}();
+
+// Table interpolated at the values of Arguments, one per axis
+template <TableType Table, SystemExpression... Arguments> requires
+    table_arguments_match<Table, Arguments...> && compatible_extents<Arguments...>
+struct Lookup
+{
+    static_assert(sizeof...(Arguments) <= 3, "tables have one to three axes");
+
+    using depends_on = to_unique_tuple_t<tuple_cat_t<typename Arguments::depends_on...>>;
+    using Unit = typename Table::Unit;
+    constexpr static std::size_t extent = common_extent_v<Arguments...>;
+
+    template <class SystemType, std::size_t N>
+    [[nodiscard]] static constexpr double evaluate(std::span<const double, N> arr, std::size_t element = 0)
+    {
+        return Table::grid.template evaluate<Table::interpolation>({Arguments::template evaluate<SystemType>(arr, element)...});
+    }
+
+    template <class SystemType>
+    static constexpr auto format_in()
+    {
+        constexpr auto compiled = []() {
+            if constexpr (sizeof...(Arguments) == 1) {
+                return FMT_COMPILE("{}({})");
+            } else if constexpr (sizeof...(Arguments) == 2) {
+                return FMT_COMPILE("{}({}, {})");
+            } else {
+                return FMT_COMPILE("{}({}, {}, {})");
+            }
+        }();
+        constexpr auto size = fmt::formatted_size(
+            compiled, Table::symbol, toView(Arguments::template format_in<SystemType>())...);
+        auto result = std::array<char, size>();
+        fmt::format_to(result.data(), compiled, Table::symbol, toView(Arguments::template format_in<SystemType>())...);
+        return result;
+    }
+};
+
+template <TableType Table, SystemExpression... Arguments>
+constexpr auto lookup(Arguments... /*arguments*/)
+{
+    return Lookup<Table, Arguments...>{};
+}
+
+} // namespace codys
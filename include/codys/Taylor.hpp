@@ -0,0 +1,418 @@
+#pragma once
+
+#include <codys/Concepts.hpp>
+#include <codys/Integrator.hpp>
+#include <codys/Operators.hpp>
+#include <codys/Quantity.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace codys
+{
+
+template <std::size_t order>
+using TaylorSeries = std::array<double, order + 1>;
+
+namespace detail
+{
+
+// Taylor coefficients in time of an expression node, mirroring the node's
+// evaluate. Every node holds the coefficients of its value and computes
+// coefficient k from coefficients 0..k of its operands, which are computed
+// first. Delayed terms and lookups have no Taylor expansion.
+template <typename Expression, std::size_t order>
+struct taylor_node;
+
+template <typename Tag, typename Unit_, StringLiteral symbol, std::size_t order>
+struct taylor_node<Quantity<Tag, Unit_, symbol>, order>
+{
+    TaylorSeries<order> series{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t /*element*/, std::size_t k)
+    {
+        series[k] = in[get_offset<Quantity<Tag, Unit_, symbol>, SystemType>()][k];
+    }
+};
+
+template <typename Tag, typename Unit_, std::size_t Size, StringLiteral symbol, std::size_t order>
+struct taylor_node<QuantityArray<Tag, Unit_, Size, symbol>, order>
+{
+    TaylorSeries<order> series{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t element, std::size_t k)
+    {
+        series[k] = in[get_offset<QuantityArray<Tag, Unit_, Size, symbol>, SystemType>() + element][k];
+    }
+};
+
+template <typename value_, typename Unit_, std::size_t order>
+struct taylor_node<ScalarValue<value_, Unit_>, order>
+{
+    TaylorSeries<order> series{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> /*in*/, std::size_t /*element*/, std::size_t k)
+    {
+        series[k] = k == 0 ? ScalarValue<value_, Unit_>::value : 0.0;
+    }
+};
+
+template <typename Lhs, typename Rhs, std::size_t order>
+struct taylor_node<Add<Lhs, Rhs>, order>
+{
+    TaylorSeries<order> series{};
+    taylor_node<Lhs, order> lhs{};
+    taylor_node<Rhs, order> rhs{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t element, std::size_t k)
+    {
+        lhs.template compute<SystemType>(in, element, k);
+        rhs.template compute<SystemType>(in, element, k);
+        series[k] = lhs.series[k] + rhs.series[k];
+    }
+};
+
+template <typename Lhs, typename Rhs, std::size_t order>
+struct taylor_node<Substract<Lhs, Rhs>, order>
+{
+    TaylorSeries<order> series{};
+    taylor_node<Lhs, order> lhs{};
+    taylor_node<Rhs, order> rhs{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t element, std::size_t k)
+    {
+        lhs.template compute<SystemType>(in, element, k);
+        rhs.template compute<SystemType>(in, element, k);
+        series[k] = lhs.series[k] - rhs.series[k];
+    }
+};
+
+// Cauchy product
+template <typename Lhs, typename Rhs, std::size_t order>
+struct taylor_node<Multiply<Lhs, Rhs>, order>
+{
+    TaylorSeries<order> series{};
+    taylor_node<Lhs, order> lhs{};
+    taylor_node<Rhs, order> rhs{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t element, std::size_t k)
+    {
+        lhs.template compute<SystemType>(in, element, k);
+        rhs.template compute<SystemType>(in, element, k);
+        double result = 0.0;
+        for (std::size_t j = 0; j <= k; ++j) {
+            result += lhs.series[j] * rhs.series[k - j];
+        }
+        series[k] = result;
+    }
+};
+
+template <typename Lhs, typename Rhs, typename Addend, std::size_t order>
+struct taylor_node<FusedMultiplyAdd<Lhs, Rhs, Addend>, order>
+{
+    TaylorSeries<order> series{};
+    taylor_node<Lhs, order> lhs{};
+    taylor_node<Rhs, order> rhs{};
+    taylor_node<Addend, order> addend{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t element, std::size_t k)
+    {
+        lhs.template compute<SystemType>(in, element, k);
+        rhs.template compute<SystemType>(in, element, k);
+        addend.template compute<SystemType>(in, element, k);
+        double result = addend.series[k];
+        for (std::size_t j = 0; j <= k; ++j) {
+            result += lhs.series[j] * rhs.series[k - j];
+        }
+        series[k] = result;
+    }
+};
+
+// from lhs = series * rhs
+template <typename Lhs, typename Rhs, std::size_t order>
+struct taylor_node<Divide<Lhs, Rhs>, order>
+{
+    TaylorSeries<order> series{};
+    taylor_node<Lhs, order> lhs{};
+    taylor_node<Rhs, order> rhs{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t element, std::size_t k)
+    {
+        lhs.template compute<SystemType>(in, element, k);
+        rhs.template compute<SystemType>(in, element, k);
+        double result = lhs.series[k];
+        for (std::size_t j = 0; j < k; ++j) {
+            result -= series[j] * rhs.series[k - j];
+        }
+        series[k] = result / rhs.series[0];
+    }
+};
+
+// sine or cosine of the operand with the other one as companion, from
+// sin' = cos u' and cos' = -sin u'
+template <typename Lhs, bool isCosine, std::size_t order>
+struct taylor_sin_cos
+{
+    TaylorSeries<order> series{};
+    TaylorSeries<order> companion{};
+    taylor_node<Lhs, order> lhs{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t element, std::size_t k)
+    {
+        lhs.template compute<SystemType>(in, element, k);
+        if (k == 0) {
+            series[0] = isCosine ? std::cos(lhs.series[0]) : std::sin(lhs.series[0]);
+            companion[0] = isCosine ? std::sin(lhs.series[0]) : std::cos(lhs.series[0]);
+            return;
+        }
+        double seriesSum = 0.0;
+        double companionSum = 0.0;
+        for (std::size_t j = 1; j <= k; ++j) {
+            const double weighted = static_cast<double>(j) * lhs.series[j];
+            seriesSum += weighted * companion[k - j];
+            companionSum += weighted * series[k - j];
+        }
+        const double sign = isCosine ? -1.0 : 1.0;
+        series[k] = sign * seriesSum / static_cast<double>(k);
+        companion[k] = -sign * companionSum / static_cast<double>(k);
+    }
+};
+
+template <typename Lhs, std::size_t order>
+struct taylor_node<Sinus<Lhs>, order> : taylor_sin_cos<Lhs, false, order>
+{
+};
+
+template <typename Lhs, std::size_t order>
+struct taylor_node<Cosinus<Lhs>, order> : taylor_sin_cos<Lhs, true, order>
+{
+};
+
+template <typename Lhs, std::size_t order>
+struct taylor_node<Sum<Lhs>, order>
+{
+    TaylorSeries<order> series{};
+    std::array<taylor_node<Lhs, order>, extent_v<Lhs>> terms{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t /*element*/, std::size_t k)
+    {
+        double result = 0.0;
+        for (std::size_t element = 0; element < extent_v<Lhs>; ++element) {
+            terms[element].template compute<SystemType>(in, element, k);
+            result += terms[element].series[k];
+        }
+        series[k] = result;
+    }
+};
+
+// Saturations and conditionals take the series of the operand selected at
+// the expansion point, which is valid up to the next switch.
+template <typename Lhs, typename Rhs, bool isMax, std::size_t order>
+struct taylor_extremum
+{
+    TaylorSeries<order> series{};
+    taylor_node<Lhs, order> lhs{};
+    taylor_node<Rhs, order> rhs{};
+    bool takeRhs{false};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t element, std::size_t k)
+    {
+        lhs.template compute<SystemType>(in, element, k);
+        rhs.template compute<SystemType>(in, element, k);
+        if (k == 0) {
+            takeRhs = isMax ? lhs.series[0] < rhs.series[0] : rhs.series[0] < lhs.series[0];
+        }
+        series[k] = takeRhs ? rhs.series[k] : lhs.series[k];
+    }
+};
+
+template <typename Lhs, typename Rhs, std::size_t order>
+struct taylor_node<Min<Lhs, Rhs>, order> : taylor_extremum<Lhs, Rhs, false, order>
+{
+};
+
+template <typename Lhs, typename Rhs, std::size_t order>
+struct taylor_node<Max<Lhs, Rhs>, order> : taylor_extremum<Lhs, Rhs, true, order>
+{
+};
+
+template <typename Lhs, typename Rhs, std::size_t order>
+struct taylor_node<Less<Lhs, Rhs>, order>
+{
+    TaylorSeries<order> series{};
+    taylor_node<Lhs, order> lhs{};
+    taylor_node<Rhs, order> rhs{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t element, std::size_t k)
+    {
+        lhs.template compute<SystemType>(in, element, k);
+        rhs.template compute<SystemType>(in, element, k);
+        series[k] = k == 0 && lhs.series[0] < rhs.series[0] ? 1.0 : 0.0;
+    }
+};
+
+template <typename Condition, typename OnTrue, typename OnFalse, std::size_t order>
+struct taylor_node<Select<Condition, OnTrue, OnFalse>, order>
+{
+    TaylorSeries<order> series{};
+    taylor_node<Condition, order> condition{};
+    taylor_node<OnTrue, order> onTrue{};
+    taylor_node<OnFalse, order> onFalse{};
+
+    template <class SystemType, std::size_t N>
+    constexpr void compute(std::span<const TaylorSeries<order>, N> in, std::size_t element, std::size_t k)
+    {
+        condition.template compute<SystemType>(in, element, k);
+        onTrue.template compute<SystemType>(in, element, k);
+        onFalse.template compute<SystemType>(in, element, k);
+        series[k] = condition.series[0] != 0.0 ? onTrue.series[k] : onFalse.series[k];
+    }
+};
+
+// the nodes of one derivative equation, one set per element
+template <typename DerivativeType, std::size_t order>
+using taylor_equation_t = std::array<taylor_node<typename DerivativeType::Expression, order>, DerivativeType::extent>;
+
+template <typename Derivatives, std::size_t order>
+struct taylor_equations;
+
+template <typename... DerivativeTypes, std::size_t order>
+struct taylor_equations<std::tuple<DerivativeTypes...>, order>
+{
+    using type = std::tuple<taylor_equation_t<DerivativeTypes, order>...>;
+};
+
+} // namespace detail
+
+// Taylor series method with adaptive step size (Jorba and Zou, "A software
+// package for the numerical integration of ODEs by means of high-order
+// Taylor methods", 2005). The time Taylor coefficients of the states are
+// computed to the order the tolerance calls for, at most maxOrder, by
+// automatic differentiation through the expression nodes; the node storage
+// is allocated with the integrator. The step is taken so that the last two
+// terms of the series stay below the tolerance, relative to the states where
+// they exceed one. Controls are held constant over a step.
+template <typename System, std::size_t maxOrder = 24>
+class TaylorIntegrator
+{
+public:
+    constexpr static std::size_t inputSize = System::stateSize + System::controlSize;
+
+    static_assert(maxOrder >= 2);
+
+    // throws std::invalid_argument unless 0 < tolerance < 1
+    constexpr explicit TaylorIntegrator(double tolerance) : tolerance_(tolerance)
+    {
+        if (!(tolerance > 0.0 && tolerance < 1.0)) {
+            throw std::invalid_argument("tolerance must lie in (0, 1)");
+        }
+        const auto wanted = static_cast<std::size_t>(std::ceil(1.0 - std::log(tolerance) / 2.0));
+        order_ = std::clamp(wanted, std::size_t{2}, maxOrder);
+    }
+
+    [[nodiscard]] constexpr std::size_t order() const { return order_; }
+
+    // Taylor coefficients of the states in time at (states, controls), up to order()
+    constexpr void expand(std::span<const double, System::stateSize> states, std::span<const double, System::controlSize> controls)
+    {
+        for (std::size_t i = 0; i < inputSize; ++i) {
+            in_[i].fill(0.0);
+            in_[i][0] = i < System::stateSize ? states[i] : controls[i - System::stateSize];
+        }
+        for (std::size_t k = 0; k < order_; ++k) {
+            [&]<std::size_t... equationIdx>(std::index_sequence<equationIdx...> /*equations*/) {
+                ([&]<typename DerivativeType>(auto& nodes) {
+                    constexpr auto offset = get_offset<typename DerivativeType::Operand, AllStates>();
+                    for (std::size_t element = 0; element < DerivativeType::extent; ++element) {
+                        nodes[element].template compute<AllStates>(std::span<const TaylorSeries<maxOrder>, inputSize>(in_), element, k);
+                        in_[offset + element][k + 1] = nodes[element].series[k] / static_cast<double>(k + 1);
+                    }
+                }.template operator()<std::tuple_element_t<equationIdx, Derivatives>>(std::get<equationIdx>(equations_)), ...);
+            }(std::make_index_sequence<System::derivativeFunctionsSize>{});
+        }
+    }
+
+    // coefficient k of state slot i after expand
+    [[nodiscard]] constexpr double coefficient(std::size_t i, std::size_t k) const { return in_[i][k]; }
+
+    // advances states by one step of at most maxStep and returns its length
+    constexpr double step(std::span<double, System::stateSize> states, std::span<const double, System::controlSize> controls,
+                          double maxStep)
+    {
+        expand(states, controls);
+        const double h = std::min(maxStep, step_size());
+        for (std::size_t i = 0; i < System::stateSize; ++i) {
+            double value = in_[i][order_];
+            for (std::size_t k = order_; k-- > 0;) {
+                value = value * h + in_[i][k];
+            }
+            states[i] = value;
+        }
+        return h;
+    }
+
+    // integrates from t0 to tEnd and returns the number of steps taken
+    constexpr std::size_t integrate(std::span<double, System::stateSize> states, std::span<const double, System::controlSize> controls,
+                                    double t0, double tEnd)
+    {
+        std::size_t steps = 0;
+        for (double t = t0; t < tEnd; ++steps) {
+            const double remaining = tEnd - t;
+            const double h = step(states, controls, remaining);
+            t = h < remaining ? t + h : tEnd;
+        }
+        return steps;
+    }
+
+private:
+    using AllStates = typename System::AllStates;
+    using Derivatives = std::remove_cvref_t<decltype(System::derivativeFunctions)>;
+
+    [[nodiscard]] constexpr double step_size() const
+    {
+        const auto norm = [this](std::size_t k) {
+            double result = 0.0;
+            for (std::size_t i = 0; i < System::stateSize; ++i) {
+                result = std::max(result, std::abs(in_[i][k]));
+            }
+            return result;
+        };
+        const double tolerance = tolerance_ * std::max(1.0, norm(0));
+        double h = std::numeric_limits<double>::infinity();
+        for (const auto k : {order_ - 1, order_}) {
+            const double size = norm(k);
+            if (size > 0.0) {
+                h = std::min(h, std::pow(tolerance / size, 1.0 / static_cast<double>(k)));
+            }
+        }
+        return h * std::exp(-0.7 / static_cast<double>(order_ - 1));
+    }
+
+    double tolerance_;
+    std::size_t order_{};
+    std::array<TaylorSeries<maxOrder>, inputSize> in_{};
+    typename detail::taylor_equations<Derivatives, maxOrder>::type equations_{};
+};
+
+} // namespace codys
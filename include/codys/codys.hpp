@@ -2,7 +2,10 @@
 
 #include "Concepts.hpp"
 #include "Derivative.hpp"
+#include "Jacobian.hpp"
 #include "Operators.hpp"
-#include "State.hpp"
+#include "Quantity.hpp"
 #include "StateSpaceSystem.hpp"
+#include "SystemInstance.hpp"
+#include "SystemInterface.hpp"
 #include <codys/tuple_utilities.hpp>
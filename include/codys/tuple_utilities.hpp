@@ -1,6 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace codys {
 
@@ -105,7 +112,7 @@ concept tuple_like = empty_tuple<Tuple> || sized_tuple<Tuple>;
 /// ********* Indexing 
 
 template<class T, tuple_like Tuple>
-static constexpr auto get_idx()
+constexpr auto get_idx()
 {
     return detail::Index<T, Tuple>::index;
 }
@@ -137,4 +144,24 @@ concept are_distinct = std::is_same_v<to_unique_tuple_t<tuple_cat_t<Lhs,Rhs>>, t
 template <tuple_like TupleA, tuple_like TupleB>
 using distinct_tuple_of = typename detail::distinct_tuple_of_impl<TupleA, TupleB, std::make_index_sequence<std::tuple_size_v<TupleA>>>::type;
 
+
+/// ********** Index sequences
+
+namespace detail {
+
+template <auto indices, typename Positions = std::make_index_sequence<indices.size()>>
+struct index_sequence_of_helper;
+
+template <auto indices, std::size_t... idx>
+struct index_sequence_of_helper<indices, std::index_sequence<idx...>>
+{
+    using type = std::index_sequence<indices[idx]...>;
+};
+
+// std::index_sequence of the values of a constexpr std::array
+template <auto indices>
+using index_sequence_of = typename index_sequence_of_helper<indices>::type;
+
+} // namespace detail
+
 } // namespace codys
\ No newline at end of file
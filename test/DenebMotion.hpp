@@ -0,0 +1,61 @@
+#pragma once
+
+#include <units/isq/si/acceleration.h>
+#include <units/isq/si/angular_acceleration.h>
+#include <units/isq/si/angular_velocity.h>
+#include <units/isq/si/frequency.h>
+#include <units/isq/si/length.h>
+#include <units/isq/si/speed.h>
+#include <units/generic/angle.h>
+#include <units/generic/dimensionless.h>
+
+#include <codys/Derivative.hpp>
+#include <codys/Operators.hpp>
+#include <codys/Quantity.hpp>
+
+#include <ratio>
+#include <tuple>
+
+// Motion model of the Deneb, shared by the validation tests and the kernel
+// generator, and a damped position with a negative rate constant.
+namespace codys
+{
+
+using PositionX0 = Quantity<class PositionX0_, units::isq::si::length<units::isq::si::metre>, "x_0">;
+using PositionX1 = Quantity<class PositionX1_, units::isq::si::length<units::isq::si::metre>, "x_1">;
+using Velocity = Quantity<class Velocity2_, units::isq::si::speed<units::isq::si::metre_per_second>, "v">;
+using Yaw = Quantity<class Yaw_, units::angle<units::radian, double>, "\\Phi">;
+using Rotation = Quantity<class Rotation_, units::isq::si::angular_velocity<units::isq::si::radian_per_second>, "\\omega">;
+using PropellerAngle = Quantity<class PropellerAngle_, units::angle<units::radian, double>, "\\Psi">;
+using EOT = Quantity<class PropellerForce_, units::dimensionless<units::one>, "EOT">;
+
+using p1 = ScalarValue<std::ratio<1, 2>, units::isq::si::acceleration<units::isq::si::metre_per_second_sq>>;
+using p2 = ScalarValue<std::ratio<1, 3>, units::isq::si::angular_acceleration<units::isq::si::radian_per_second_sq>>;
+using hundret = ScalarValue<std::ratio<100>, units::dimensionless<units::one>>;
+
+struct DenebMotion
+{
+    constexpr static auto make_dot()
+    {
+        constexpr auto dot_pos_x0 = codys::dot<PositionX0>(Velocity{} * codys::cos(Yaw{}));
+        constexpr auto dot_pos_x1 = codys::dot<PositionX1>(Velocity{} * codys::sin(Yaw{}));
+        constexpr auto dot_velocity = codys::dot<Velocity>(p1{} * codys::cos(PropellerAngle{}) * (EOT{} / hundret{}));
+        constexpr auto dot_yaw = codys::dot<Yaw>(Rotation{});
+        constexpr auto dot_rotation = codys::dot<Rotation>(p2{} * codys::sin(PropellerAngle{}) * (EOT{} / hundret{}));
+
+        return std::make_tuple(dot_pos_x0, dot_pos_x1, dot_yaw, dot_velocity, dot_rotation);
+    }
+};
+
+// negative, so generated kernels negate literals
+using rate = ScalarValue<std::ratio<-2>, units::isq::si::frequency<units::isq::si::hertz>>;
+
+struct DampedPosition
+{
+    constexpr static auto make_dot()
+    {
+        return std::make_tuple(codys::dot<PositionX0>(Velocity{} - rate{} * PositionX0{}));
+    }
+};
+
+} // namespace codys
@@ -13,9 +13,17 @@
 #include <codys/Quantity.hpp>
 #include <codys/tuple_utilities.hpp>
 #include <codys/StateSpaceSystem.hpp>
+#include <codys/Partition.hpp>
+#include <codys/CostModel.hpp>
+#include <codys/Events.hpp>
+#include <codys/HybridSystem.hpp>
+#include <codys/Integrator.hpp>
+#include <codys/Jacobian.hpp>
+#include <codys/Stochastic.hpp>
 
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <tuple>
 #include <type_traits>
 #include <string_view>
@@ -44,6 +52,8 @@ using Acceleration = codys::Quantity<class Acceleration_, units::isq::si::accele
 using namespace units::isq::si::references;
 using dacc_ds_unit = std::remove_cvref_t<decltype(std::declval<units::isq::si::acceleration<units::isq::si::metre_per_second_sq>>() / (1*s))>;
 using PropellerForce = codys::Quantity<class PropellerForce_, dacc_ds_unit>;
+using Heading = codys::Quantity<class Heading_, units::angle<units::radian, double>>;
+using HeadingRate = codys::Quantity<class HeadingRate_, codys::detail::derivative_in_time_t<units::angle<units::radian, double>>>;
 
 struct TestSystemMotions
 {
@@ -469,4 +479,368 @@ TEST_CASE("Systems are combined correctly", "[TypeUtil]")
   [[maybe_unused]] static constexpr auto derivatives = CombinedSys::make_dot();
 }
 
-} // namespace codys_constexpr_tests 
\ No newline at end of file
+TEST_CASE("Expressions are simplified into a canonical form", "[Simplify]")
+{
+  using Two = codys::ScalarValue<std::ratio<2>, codys::Dimensionless>;
+  using Zero = codys::ScalarValue<std::ratio<0>, Acceleration::Unit>;
+  using One = codys::ScalarValue<std::ratio<1>, codys::Dimensionless>;
+  using AccelerationOffset = codys::ScalarValue<std::ratio<3>, Acceleration::Unit>;
+  using Braking = codys::Quantity<class Braking_, Acceleration::Unit>;
+
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<codys::Add<Acceleration, Acceleration>>, codys::Multiply<Two, Acceleration>>);
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<codys::Substract<Acceleration, Acceleration>>, Zero>);
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<codys::Add<Acceleration, Zero>>, Acceleration>);
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<codys::Multiply<Acceleration, One>>, Acceleration>);
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<codys::Multiply<codys::ScalarValue<std::ratio<0>, codys::Dimensionless>, Acceleration>>, Zero>);
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<codys::Add<AccelerationOffset, AccelerationOffset>>, codys::ScalarValue<std::ratio<6>, Acceleration::Unit>>);
+
+  // operands of commutative nodes are ordered, positive terms come first
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<decltype(Acceleration{} + Braking{})>, codys::simplify_t<decltype(Braking{} + Acceleration{})>>);
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<decltype(Velocity{} * codys::cos(Rotation{}))>,
+                                codys::simplify_t<decltype(codys::cos(Rotation{}) * Velocity{})>>);
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<decltype(Zero{} - Acceleration{} + Braking{})>, codys::Substract<Braking, Acceleration>>);
+
+  // 2 * a + (a - 3 * a) + a == a
+  using Three = codys::ScalarValue<std::ratio<3>, codys::Dimensionless>;
+  using Expression = codys::Add<codys::Add<codys::Multiply<Two, Acceleration>,
+                                           codys::Substract<Acceleration, codys::Multiply<Three, Acceleration>>>,
+                                Acceleration>;
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<Expression>, Acceleration>);
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<codys::simplify_t<Expression>>, codys::simplify_t<Expression>>);
+
+  // ordered by symbol rather than by the compiler's spelling of the tag
+  using Alpha = codys::Quantity<class Zulu_, Acceleration::Unit, "a">;
+  using Bravo = codys::Quantity<class Alpha_, Acceleration::Unit, "b">;
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<codys::Add<Bravo, Alpha>>, codys::Add<Alpha, Bravo>>);
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<codys::Add<Bravo, codys::Multiply<Two, Alpha>>>,
+                                codys::Add<codys::Multiply<Two, Alpha>, Bravo>>);
+
+  // dividing by constants other than one stays exact
+  using Halved = codys::Divide<Acceleration, Two>;
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<Halved>, Halved>);
+}
+
+TEST_CASE("Combined systems are simplified when formed", "[Simplify]")
+{
+  using Sys = codys::StateSpaceSystemOf<codys::combine<TestSystemMotions, TestSystemMotionsVelOnly>>;
+  using VelocityEquation = std::tuple_element_t<0, std::remove_cvref_t<decltype(Sys::derivativeFunctions)>>;
+  STATIC_REQUIRE(std::is_same_v<VelocityEquation::Operand, Velocity>);
+  STATIC_REQUIRE(std::is_same_v<VelocityEquation::Expression, codys::Multiply<codys::ScalarValue<std::ratio<4>, codys::Dimensionless>, Acceleration>>);
+}
+
+struct TestSystemHeadingOnly
+{
+  constexpr static auto make_dot()
+  {
+    constexpr auto dot_heading = codys::dot<Heading>(HeadingRate{});
+    return std::make_tuple(dot_heading);
+  }
+};
+
+TEST_CASE("Coupled equations are spread over groups of similar cost", "[Partition]")
+{
+  using Derivatives = std::remove_cvref_t<decltype(TestSystemMotions::make_dot())>;
+  using Partition = codys::equation_partition<Derivatives, 2>;
+
+  STATIC_REQUIRE(Partition::groupCount == 2);
+  STATIC_REQUIRE(Partition::groupOf == std::array<std::size_t, 3>{0, 0, 1});
+  STATIC_REQUIRE(Partition::members<1> == std::array<std::size_t, 1>{2});
+  STATIC_REQUIRE(Partition::groupCost[0] == Partition::equationCost[0] + Partition::equationCost[1]);
+  STATIC_REQUIRE(codys::equation_partition<Derivatives>::groupCount == 3);
+  STATIC_REQUIRE(codys::equation_partition<Derivatives, 1>::groupCount == 1);
+}
+
+TEST_CASE("Partition groups are dispatched by descending cost", "[Partition]")
+{
+  using CombinedSys = codys::combine<TestSystemHeadingOnly, TestSystemMotions>;
+  using Partition = codys::equation_partition<std::remove_cvref_t<decltype(CombinedSys::make_dot())>, 2>;
+
+  STATIC_REQUIRE(Partition::groupCost[0] < Partition::groupCost[1]);
+  STATIC_REQUIRE(Partition::totalCost == Partition::groupCost[0] + Partition::groupCost[1]);
+  STATIC_REQUIRE(Partition::dispatchOrder == std::array<std::size_t, 2>{1, 0});
+}
+
+using PositionArray = codys::QuantityArray<class PositionArray_, PositionUnit, 3>;
+
+TEST_CASE("QuantityArray occupies consecutive slots", "[QuantityArray]")
+{
+  using TestSystem = std::tuple<Position, PositionArray, Velocity>;
+  STATIC_REQUIRE(codys::get_offset<Position, TestSystem>() == 0);
+  STATIC_REQUIRE(codys::get_offset<PositionArray, TestSystem>() == 1);
+  STATIC_REQUIRE(codys::get_offset<Velocity, TestSystem>() == 4);
+  STATIC_REQUIRE(codys::slot_count_v<TestSystem> == 5);
+}
+
+TEST_CASE("Expression of QuantityArray and scalar is evaluated element-wise", "[QuantityArray]")
+{
+  static constexpr auto plus = PositionArray{} + Position{};
+  static constexpr std::array values{ 10.0, 1.0, 2.0, 3.0 };
+  using TestSystem = std::tuple<Position, PositionArray>;
+
+  STATIC_REQUIRE(decltype(plus)::extent == 3);
+  STATIC_REQUIRE(plus.evaluate<TestSystem, 4>(values, 0) == 11.0);
+  STATIC_REQUIRE(plus.evaluate<TestSystem, 4>(values, 2) == 13.0);
+}
+
+TEST_CASE("Sum reduces QuantityArray to a scalar", "[QuantityArray]")
+{
+  static constexpr auto total = codys::sum(PositionArray{} + PositionArray{});
+  static constexpr std::array values{ 1.0, 2.0, 3.0 };
+  using TestSystem = std::tuple<PositionArray>;
+
+  STATIC_REQUIRE(decltype(total)::extent == 1);
+  STATIC_REQUIRE(std::is_same_v<decltype(total)::Unit, PositionUnit>);
+  STATIC_REQUIRE(total.evaluate<TestSystem, 3>(values) == 12.0);
+}
+
+struct TestSystemUniformAcceleration
+{
+  constexpr static auto make_dot()
+  {
+    constexpr auto dot_position = codys::dot<Position>(Velocity{});
+    constexpr auto dot_velocity = codys::dot<Velocity>(Acceleration{});
+    return std::make_tuple(dot_position, dot_velocity);
+  }
+};
+
+constexpr auto integrate_once = []<typename Stepper>(Stepper /*stepper*/) {
+  using Sys = codys::StateSpaceSystemOf<TestSystemUniformAcceleration>;
+  std::array states{ 0.0, 1.0 };
+  constexpr std::array controls{ 2.0 };
+  Stepper::template step<Sys>(states, controls, 0.5);
+  return states;
+};
+
+TEST_CASE("Explicit Euler step is evaluated correctly", "[Integrator]")
+{
+  STATIC_REQUIRE(integrate_once(codys::ExplicitEuler{}) == std::array{ 0.5, 2.0 });
+}
+
+TEST_CASE("Runge-Kutta steps are exact for uniform acceleration", "[Integrator]")
+{
+  // x(t) = x0 + v0 t + a t^2 / 2 is a polynomial of second order
+  constexpr auto heun = integrate_once(codys::Heun{});
+  constexpr auto rk4 = integrate_once(codys::RungeKutta4{});
+  STATIC_REQUIRE(std::abs(heun[0] - 0.75) < 1e-12);
+  STATIC_REQUIRE(std::abs(rk4[0] - 0.75) < 1e-12);
+  STATIC_REQUIRE(rk4[1] == 2.0);
+}
+
+TEST_CASE("Trajectories are simulated at compile time", "[Integrator]")
+{
+  using Sys = codys::StateSpaceSystemOf<TestSystemUniformAcceleration>;
+  // x = t + t^2 sampled every 0.1 s from steps of 0.05 s
+  constexpr auto trajectory = codys::simulate<Sys, 11, 2>({ 0.0, 1.0 }, { 2.0 }, 0.05);
+  STATIC_REQUIRE(trajectory[0] == std::array{ 0.0, 1.0 });
+  STATIC_REQUIRE(std::abs(trajectory[5][0] - 0.75) < 1e-12);
+  STATIC_REQUIRE(std::abs(trajectory[10][0] - 2.0) < 1e-12);
+  STATIC_REQUIRE(std::abs(trajectory[10][1] - 3.0) < 1e-12);
+}
+
+TEST_CASE("Events are located within a step", "[Events]")
+{
+  using Sys = codys::StateSpaceSystemOf<TestSystemUniformAcceleration>;
+  // x(t) = t + t^2, v(t) = 1 + 2 t
+  constexpr auto result = []() {
+    std::array states{ 0.0, 1.0 };
+    constexpr std::array controls{ 2.0 };
+    constexpr auto speedLimit = codys::event<codys::EventDirection::Rising, codys::EventAction::Continue>(
+      Velocity{} - codys::ScalarValue<std::ratio<11, 5>, VelocityUnit>{});
+    constexpr auto waypoint = codys::event<codys::EventDirection::Rising>(
+      Position{} - codys::ScalarValue<std::ratio<3>, PositionUnit>{});
+
+    std::array<double, 2> eventTimes{};
+    std::size_t eventCount = 0;
+    const double stop = codys::integrate_with_events<Sys>(states, controls, 0.0, 10.0, 0.25,
+      std::make_tuple(speedLimit, waypoint),
+      [&](std::size_t eventIdx, double time, std::span<const double, 2> /*states*/) {
+        eventTimes[eventIdx] = time;
+        ++eventCount;
+      });
+    return std::make_tuple(stop, eventTimes, eventCount, states);
+  }();
+
+  // stop time, time of each event, number of events, final states
+  STATIC_REQUIRE(std::get<2>(result) == 2);
+  STATIC_REQUIRE(std::abs(std::get<1>(result)[0] - 0.6) < 1e-12);
+  STATIC_REQUIRE(std::abs(std::get<0>(result) - 1.3027756377319946) < 1e-12);
+  STATIC_REQUIRE(std::get<1>(result)[1] == std::get<0>(result));
+  STATIC_REQUIRE(std::abs(std::get<3>(result)[0] - 3.0) < 1e-12);
+}
+
+struct Cruising
+{
+  constexpr static auto make_dot()
+  {
+    using AccelerationUnit = units::isq::si::acceleration<units::isq::si::metre_per_second_sq>;
+    constexpr auto dot_position = codys::dot<Position>(Velocity{});
+    constexpr auto dot_velocity = codys::dot<Velocity>(codys::ScalarValue<std::ratio<0>, AccelerationUnit>{});
+    return std::make_tuple(dot_position, dot_velocity);
+  }
+};
+
+// accelerate up to 2 m/s, cruise until 5 m, then drop to 1 m/s and accelerate again
+using CruiseControl = codys::HybridSystem<
+  std::tuple<Position, Velocity>, std::tuple<Acceleration>,
+  std::tuple<TestSystemUniformAcceleration, Cruising>,
+  decltype(std::make_tuple(
+    codys::transition<0, 1>(codys::event<codys::EventDirection::Rising>(Velocity{} - codys::ScalarValue<std::ratio<2>, VelocityUnit>{})),
+    codys::transition<1, 0>(codys::event<codys::EventDirection::Rising>(Position{} - codys::ScalarValue<std::ratio<5>, PositionUnit>{}),
+                            codys::reset<Velocity>(codys::ScalarValue<std::ratio<1>, VelocityUnit>{}))))>;
+
+TEST_CASE("HybridSystem dispatches to the active mode", "[HybridSystem]")
+{
+  constexpr auto derivatives = [](std::size_t mode) {
+    constexpr std::array statesIn{ 0.0, 1.0, 2.0 };
+    std::array out{ 0.0, 0.0 };
+    CruiseControl::evaluate(mode, statesIn, out);
+    return out;
+  };
+  STATIC_REQUIRE(derivatives(0) == std::array{ 1.0, 2.0 });
+  STATIC_REQUIRE(derivatives(1) == std::array{ 1.0, 0.0 });
+  STATIC_REQUIRE(CruiseControl::outgoing<1> == std::array<std::size_t, 1>{ 1 });
+}
+
+TEST_CASE("HybridSystem switches modes at the guard crossings", "[HybridSystem]")
+{
+  constexpr auto result = []() {
+    std::array states{ 0.0, 1.0 };
+    constexpr std::array controls{ 2.0 };
+    std::array<double, 3> switchTimes{};
+    std::size_t switches = 0;
+    const auto mode = codys::integrate_hybrid<CruiseControl>(0, states, controls, 0.0, 4.0, 0.3,
+      [&](std::size_t /*from*/, std::size_t /*to*/, double time, std::span<const double, 2> /*states*/) {
+        switchTimes[switches++] = time;
+      });
+    return std::make_tuple(mode, switches, switchTimes, states);
+  }();
+
+  // final mode, number of switches, switch times, final states
+  STATIC_REQUIRE(std::get<0>(result) == 1);
+  STATIC_REQUIRE(std::get<1>(result) == 3);
+  STATIC_REQUIRE(std::abs(std::get<2>(result)[0] - 0.5) < 1e-12);
+  STATIC_REQUIRE(std::abs(std::get<2>(result)[1] - 2.625) < 1e-12);
+  STATIC_REQUIRE(std::abs(std::get<2>(result)[2] - 3.125) < 1e-12);
+  STATIC_REQUIRE(std::abs(std::get<3>(result)[0] - 7.5) < 1e-12);
+  STATIC_REQUIRE(std::abs(std::get<3>(result)[1] - 2.0) < 1e-12);
+}
+
+TEST_CASE("Jacobian is evaluated correctly", "[Jacobian]")
+{
+  using Sys = codys::StateSpaceSystemOf<TestSystemMotions>;
+  // goes through std::sin and std::cos, which are not constexpr
+  static const auto jacobian = []() {
+    // v, x_0, x_1, a, phi
+    constexpr std::array statesIn{ 2.0, 0.0, 0.0, 1.0, 0.0 };
+    std::array<double, 3 * 5> out{};
+    codys::jacobian<Sys>(statesIn, out);
+    return out;
+  }();
+  REQUIRE(jacobian == std::array{
+    0.0, 0.0, 0.0, 2.0, 0.0,
+    1.0, 0.0, 0.0, 0.0, 0.0,
+    0.0, 0.0, 0.0, 0.0, 2.0 });
+}
+
+TEST_CASE("Cost model counts operations per equation and in total", "[CostModel]")
+{
+  using Cost = codys::system_cost<codys::StateSpaceSystemOf<TestSystemMotions>>;
+
+  // a + a is simplified to 2 * a
+  STATIC_REQUIRE(Cost::equations[0] == codys::OperationCounts{.multiplies = 1, .depth = 1});
+  STATIC_REQUIRE(Cost::equations[1] == codys::OperationCounts{.multiplies = 1, .transcendentals = 1, .depth = 2});
+  STATIC_REQUIRE(Cost::total == codys::OperationCounts{.multiplies = 3, .transcendentals = 2, .depth = 2});
+  STATIC_REQUIRE(Cost::fanIn == std::array<std::size_t, 3>{1, 2, 2});
+  STATIC_REQUIRE(Cost::maxFanIn == 2);
+  STATIC_REQUIRE(Cost::weightedCost == 43);
+  STATIC_REQUIRE(Cost::strategy == codys::EvaluationStrategy::Scalar);
+}
+
+TEST_CASE("Cost model counts sums as sequential adds", "[CostModel]")
+{
+  using Total = decltype(codys::sum(PositionArray{} + PositionArray{}));
+  STATIC_REQUIRE(codys::expression_cost_v<Total> == codys::OperationCounts{.adds = 6, .depth = 4});
+}
+
+TEST_CASE("Philox matches its known-answer vectors", "[Stochastic]")
+{
+  STATIC_REQUIRE(codys::detail::philox4x32({0, 0, 0, 0}, {0, 0}) ==
+                 std::array<std::uint32_t, 4>{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+  STATIC_REQUIRE(codys::detail::philox4x32({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}) ==
+                 std::array<std::uint32_t, 4>{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+}
+
+using AccelerationUnit = units::isq::si::acceleration<units::isq::si::metre_per_second_sq>;
+
+struct SaturatedDrive
+{
+  constexpr static auto make_dot()
+  {
+    constexpr auto drive = codys::clamp(Acceleration{}, codys::ScalarValue<std::ratio<-2>, AccelerationUnit>{},
+                                        codys::ScalarValue<std::ratio<3>, AccelerationUnit>{});
+    constexpr auto belowLimit = codys::less(Velocity{}, codys::ScalarValue<std::ratio<10>, VelocityUnit>{});
+    return std::make_tuple(codys::dot<Velocity>(
+        codys::select(belowLimit, drive, codys::ScalarValue<std::ratio<0>, AccelerationUnit>{})));
+  }
+};
+
+TEST_CASE("Saturation and select are evaluated and differentiated", "[Operators]")
+{
+  using Sys = codys::StateSpaceSystemOf<SaturatedDrive>;
+  constexpr auto evaluate = [](double velocity, double acceleration) {
+    std::array<double, 1> out{};
+    Sys::evaluate(std::array{ velocity, acceleration }, out);
+    return out[0];
+  };
+  STATIC_REQUIRE(evaluate(5.0, 5.0) == 3.0);
+  STATIC_REQUIRE(evaluate(5.0, -5.0) == -2.0);
+  STATIC_REQUIRE(evaluate(5.0, 1.0) == 1.0);
+  STATIC_REQUIRE(evaluate(12.0, 1.0) == 0.0);
+
+  constexpr auto jacobian = [](double velocity, double acceleration) {
+    std::array<double, 2> out{};
+    codys::jacobian<Sys>(std::array{ velocity, acceleration }, out);
+    return out;
+  };
+  STATIC_REQUIRE(jacobian(5.0, 1.0) == std::array{ 0.0, 1.0 });
+  STATIC_REQUIRE(jacobian(5.0, 5.0) == std::array{ 0.0, 0.0 });
+  STATIC_REQUIRE(jacobian(12.0, 1.0) == std::array{ 0.0, 0.0 });
+}
+
+using Gain = codys::Quantity<class Gain_, Dimensionless>;
+using Thrust0 = codys::Quantity<class Thrust0_, Acceleration::Unit>;
+using Thrust1 = codys::Quantity<class Thrust1_, Acceleration::Unit>;
+using Thrust2 = codys::Quantity<class Thrust2_, Acceleration::Unit>;
+using Thrust3 = codys::Quantity<class Thrust3_, Acceleration::Unit>;
+
+TEST_CASE("Sums are evaluated as balanced trees and contracted to fused multiply-adds", "[Schedule]")
+{
+  // as folded by combineExpressions
+  using Chain = codys::Add<Thrust0, codys::Add<Thrust1, codys::Add<Thrust2, Thrust3>>>;
+  STATIC_REQUIRE(std::is_same_v<codys::schedule_t<Chain, false>,
+                                codys::Add<codys::Add<Thrust0, Thrust1>, codys::Add<Thrust2, Thrust3>>>);
+  STATIC_REQUIRE(codys::expression_cost_v<Chain>.depth == 3);
+  STATIC_REQUIRE(codys::expression_cost_v<codys::schedule_t<Chain, false>>.depth == 2);
+
+  using Mixed = codys::Substract<codys::Add<codys::Substract<Thrust0, Thrust1>, Thrust2>, Thrust3>;
+  STATIC_REQUIRE(std::is_same_v<codys::schedule_t<Mixed, false>,
+                                codys::Substract<codys::Add<Thrust0, Thrust2>, codys::Add<Thrust1, Thrust3>>>);
+
+  using Scaled = codys::Add<codys::Multiply<Gain, Thrust0>, Thrust1>;
+  using Fused = codys::FusedMultiplyAdd<Gain, Thrust0, Thrust1>;
+  STATIC_REQUIRE(std::is_same_v<codys::schedule_t<Scaled, true>, Fused>);
+  STATIC_REQUIRE(std::is_same_v<codys::schedule_t<Scaled, false>, Scaled>);
+  STATIC_REQUIRE(std::is_same_v<codys::simplify_t<Fused>, codys::simplify_t<Scaled>>);
+  STATIC_REQUIRE(codys::expression_cost_v<Fused> == codys::OperationCounts{.fusedMultiplyAdds = 1, .depth = 1});
+
+  using Inputs = std::tuple<Gain, Thrust0, Thrust1>;
+  constexpr std::array in{ 3.0, 2.0, -1.0 };
+  STATIC_REQUIRE(Fused::evaluate<Inputs>(std::span<const double, 3>(in)) == 5.0);
+  constexpr auto dGain = codys::detail::forward_node<Fused>::evaluate<Inputs>(std::span<const double, 3>(in), 0, 0);
+  constexpr auto dAddend = codys::detail::forward_node<Fused>::evaluate<Inputs>(std::span<const double, 3>(in), 0, 2);
+  STATIC_REQUIRE(dGain.value == 5.0);
+  STATIC_REQUIRE(dGain.derivative == 2.0);
+  STATIC_REQUIRE(dAddend.derivative == 1.0);
+}
+
+} // namespace codys_constexpr_tests
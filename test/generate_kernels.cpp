@@ -0,0 +1,22 @@
+#include "DenebMotion.hpp"
+
+#include <codys/CodeGen.hpp>
+#include <codys/StateSpaceSystem.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <span>
+
+// writes the kernels compiled into kernel_tests
+int main(int argc, char** argv)
+{
+    const std::span arguments(argv, static_cast<std::size_t>(argc));
+    if (arguments.size() != 2) {
+        std::cerr << "usage: generate_kernels <output.c>\n";
+        return 1;
+    }
+    std::ofstream out(arguments[1]);
+    out << codys::generate_kernel<codys::StateSpaceSystemOf<codys::DenebMotion>>("deneb", {.jacobian = true});
+    out << codys::generate_kernel<codys::StateSpaceSystemOf<codys::DampedPosition>>("damped", {.jacobian = true});
+    return out ? 0 : 1;
+}
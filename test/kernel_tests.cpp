@@ -0,0 +1,73 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "DenebMotion.hpp"
+
+#include <codys/Jacobian.hpp>
+#include <codys/StateSpaceSystem.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+// generated by generate_kernels from the same model
+extern "C" {
+void deneb(const double* in, double* out);
+void deneb_jacobian(const double* in, double* jac);
+void damped(const double* in, double* out);
+void damped_jacobian(const double* in, double* jac);
+}
+
+namespace
+{
+
+using Sys = codys::StateSpaceSystemOf<codys::DenebMotion>;
+using Damped = codys::StateSpaceSystemOf<codys::DampedPosition>;
+
+constexpr std::array<std::array<double, 7>, 4> inputs{{
+    { 0.0, 0.0, 0.0, 0.0, 0.0, 2.0, 50.0 },
+    { 1.0, -2.0, 0.3, 4.0, 0.1, 0.2, 50.0 },
+    { -3.5, 7.25, -1.2, 0.01, -0.4, 3.1, -80.0 },
+    { 1e3, -1e-3, 6.0, 1e-9, 2.5, -0.75, 1e5 },
+}};
+
+} // namespace
+
+TEST_CASE("Compiled kernel evaluates bit-identically to the system", "[CodeGen]")
+{
+  for (const auto& statesIn : inputs) {
+    std::array<double, Sys::stateSize> expected{};
+    std::array<double, Sys::stateSize> out{};
+    Sys::evaluate(statesIn, expected);
+    deneb(statesIn.data(), out.data());
+    REQUIRE(out == expected);
+  }
+}
+
+TEST_CASE("Compiled Jacobian kernel matches the forward-mode Jacobian", "[CodeGen]")
+{
+  constexpr auto inputSize = Sys::stateSize + Sys::controlSize;
+  for (const auto& statesIn : inputs) {
+    std::array<double, Sys::stateSize * inputSize> expected{};
+    std::array<double, Sys::stateSize * inputSize> jac{};
+    codys::jacobian<Sys>(statesIn, expected);
+    deneb_jacobian(statesIn.data(), jac.data());
+    for (std::size_t entry = 0; entry < jac.size(); ++entry) {
+      REQUIRE(std::abs(jac[entry] - expected[entry]) <= 1e-12 * std::max(1.0, std::abs(expected[entry])));
+    }
+  }
+}
+
+TEST_CASE("Compiled kernel negates negative constants", "[CodeGen]")
+{
+  // x_0, v
+  constexpr std::array statesIn{ 1.5, -0.25 };
+  std::array<double, Damped::stateSize> expected{};
+  std::array<double, Damped::stateSize> out{};
+  Damped::evaluate(statesIn, expected);
+  damped(statesIn.data(), out.data());
+  REQUIRE(out == expected);
+
+  std::array<double, 2> jac{};
+  damped_jacobian(statesIn.data(), jac.data());
+  REQUIRE(jac == std::array{ 2.0, 1.0 });
+}
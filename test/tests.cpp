@@ -11,12 +11,35 @@
 #include <codys/Operators.hpp>
 #include <codys/Quantity.hpp>
 #include <codys/StateSpaceSystem.hpp>
+#include <codys/Delay.hpp>
+#include <codys/DependencyGraph.hpp>
+#include <codys/Instrumentation.hpp>
+#include <codys/MultiRate.hpp>
+#include <codys/Output.hpp>
+#include <codys/ParallelEvaluation.hpp>
+#include <codys/Parareal.hpp>
+#include <codys/RealTimeRunner.hpp>
+#include <codys/RuntimeSystem.hpp>
+#include <codys/Signal.hpp>
+#include <codys/Stochastic.hpp>
+#include <codys/Symplectic.hpp>
+#include <codys/Taylor.hpp>
+#include <codys/Table.hpp>
+#include <codys/Jacobian.hpp>
+#include <codys/Linear.hpp>
 #include <codys/tuple_utilities.hpp>
 
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <sstream>
 #include <tuple>
 #include <type_traits>
 #include <string>
+#include <vector>
+#include <stdexcept>
 
 using PositionX0 = codys::Quantity<class PositionX0_, units::isq::si::length<units::isq::si::metre>, "x_0">;
 using PositionX1 = codys::Quantity<class PositionX1_, units::isq::si::length<units::isq::si::metre>, "x_1">;
@@ -137,5 +160,863 @@ TEST_CASE("Formatted Value String contains State Symbols", "[SystemFormat]")
   constexpr std::array states{1.0, 2.0, 3.0};
   const auto formatStr = Sys::format_values(states);
     using namespace std::literals::string_literals;
-  REQUIRE(formatStr == "6 = 3 + 3;\n1 = 1;\n"s);
+  REQUIRE(formatStr == "6 = 2 * 3;\n1 = 1;\n"s);
+}
+
+using Heading = codys::Quantity<class Heading_, units::angle<units::radian, double>, "\\psi">;
+using HeadingRate = codys::Quantity<class HeadingRate_, codys::detail::derivative_in_time_t<units::angle<units::radian, double>>, "r">;
+
+struct HeadingControl
+{
+  constexpr static auto make_dot()
+  {
+    constexpr auto dot_heading = codys::dot<Heading>(HeadingRate{});
+    return std::make_tuple(dot_heading);
+  }
+};
+
+struct Motion2DWithHeading
+{
+  constexpr static auto make_dot()
+  {
+    return codys::combine<Motion2D, HeadingControl>::make_dot();
+  }
+};
+
+TEST_CASE("Parallel evaluation matches serial evaluation", "[ParallelEvaluation]")
+{
+  using Sys = codys::StateSpaceSystemOf<Motion2DWithHeading>;
+  STATIC_REQUIRE(codys::equation_partition_of<Sys>::groupCount > 1);
+
+  // determined to Velocity, PositionX0, PositionX1, Heading, Acceleration, Rotation, HeadingRate
+  constexpr std::array statesIn{ 2.0, 0.0, 0.0, 1.0, 3.0, 0.5, 0.25};
+
+  std::array serialOut{ 0.0, 0.0, 0.0, 0.0};
+  Sys::evaluate(statesIn, serialOut);
+
+  codys::ThreadPool pool(2);
+  for (int repetition = 0; repetition < 100; ++repetition) {
+    std::array parallelOut{ 0.0, 0.0, 0.0, 0.0};
+    codys::evaluate_parallel<Sys, 0>(pool, statesIn, parallelOut);
+    REQUIRE(parallelOut == serialOut);
+  }
+}
+
+TEST_CASE("Parallel evaluation below threshold falls back to serial evaluation", "[ParallelEvaluation]")
+{
+  using Sys = codys::StateSpaceSystemOf<Motion2DWithHeading>;
+  constexpr std::array statesIn{ 2.0, 0.0, 0.0, 1.0, 3.0, 0.5, 0.25};
+
+  // several groups, so only the cost threshold keeps the evaluation serial
+  STATIC_REQUIRE(codys::equation_partition_of<Sys>::groupCount > 1);
+  STATIC_REQUIRE(codys::equation_partition_of<Sys>::totalCost < codys::parallel_evaluation_threshold);
+  STATIC_REQUIRE_FALSE(codys::dispatches_parallel<Sys>);
+  STATIC_REQUIRE(codys::dispatches_parallel<Sys, 0>);
+
+  codys::ThreadPool pool(2);
+  REQUIRE(pool.concurrency() >= 2);
+  std::array out{ 0.0, 0.0, 0.0, 0.0};
+  codys::evaluate_parallel<Sys>(pool, statesIn, out);
+
+  constexpr std::array expectedOutput{6.0, 2.0 * std::cos(0.5), 2.0 * std::sin(0.5), 0.25};
+  constexpr auto checkTol = 1e-06;
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    REQUIRE(std::abs(out[i] - expectedOutput[i]) < checkTol);
+  }
+}
+
+constexpr std::size_t fleetSize = 4;
+using FleetPosition = codys::QuantityArray<class FleetPosition_, units::isq::si::length<units::isq::si::metre>, fleetSize, "x">;
+using FleetVelocity = codys::QuantityArray<class FleetVelocity_, units::isq::si::speed<units::isq::si::metre_per_second>, fleetSize, "v">;
+using per_second_unit = std::remove_cvref_t<decltype(1 / (1*s))>;
+using cohesion = codys::ScalarValue<std::ratio<1, 2>, per_second_unit>;
+using cohesion_per_body = codys::ScalarValue<std::ratio<1, 2 * fleetSize>, per_second_unit>;
+
+struct Fleet
+{
+  constexpr static auto make_dot()
+  {
+    // every body is pulled towards the fleet's mean position
+    constexpr auto dot_pos = codys::dot<FleetPosition>(FleetVelocity{} + (cohesion_per_body{} * codys::sum(FleetPosition{}) - cohesion{} * FleetPosition{}));
+    constexpr auto dot_vel = codys::dot<FleetVelocity>(Acceleration{});
+    return std::make_tuple(dot_pos, dot_vel);
+  }
+};
+
+TEST_CASE("QuantityArray system is evaluated element-wise", "[QuantityArray]")
+{
+  using Sys = codys::StateSpaceSystemOf<Fleet>;
+  STATIC_REQUIRE(Sys::stateSize == 2 * fleetSize);
+  STATIC_REQUIRE(Sys::controlSize == 1);
+
+  // determined to FleetPosition[4], FleetVelocity[4], Acceleration
+  constexpr std::array statesIn{ 0.0, 2.0, 4.0, 6.0, 1.0, 1.0, -1.0, 0.0, 0.5};
+
+  std::array<double, Sys::stateSize> out{};
+  Sys::evaluate(statesIn, out);
+
+  constexpr std::array expectedOutput{ 2.5, 1.5, -1.5, -1.5, 0.5, 0.5, 0.5, 0.5};
+  constexpr auto checkTol = 1e-06;
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    REQUIRE(std::abs(out[i] - expectedOutput[i]) < checkTol);
+  }
+}
+
+namespace
+{
+codys::RuntimeModel runtimeMotion2D()
+{
+  codys::RuntimeModel model;
+  model.add_state("x_0", "m");
+  model.add_state("x_1", "m");
+  model.add_state("v", "m/s");
+  model.add_control("a", "m/s^2");
+  model.add_control("Phi", "rad");
+  model.add_derivative("x_0", "v * cos(Phi)");
+  model.add_derivative("x_1", "v * sin(Phi)");
+  model.add_derivative("v", "a + a - 0.5[1/s] * v");
+  return model;
+}
+} // namespace
+
+TEST_CASE("RuntimeModel is evaluated correctly", "[RuntimeSystem]")
+{
+  auto sys = runtimeMotion2D().compile();
+  REQUIRE(sys.stateSize() == 3);
+  REQUIRE(sys.controlSize() == 2);
+
+  constexpr std::array statesIn{ 0.0, 0.0, 2.0, 1.5, 0.0 };
+  std::array out{ 0.0, 0.0, 0.0 };
+  sys.evaluate(statesIn, out);
+
+  constexpr std::array expectedOutput{ 2.0, 0.0, 2.0 };
+  constexpr auto checkTol = 1e-12;
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    REQUIRE(std::abs(out[i] - expectedOutput[i]) < checkTol);
+  }
+}
+
+TEST_CASE("RuntimeModel rejects inconsistent units", "[RuntimeSystem]")
+{
+  codys::RuntimeModel model;
+  model.add_state("x", "m");
+  model.add_state("v", "m/s");
+  model.add_derivative("x", "v");
+
+  SECTION("sum of different units") {
+    model.add_derivative("v", "v + x");
+    REQUIRE_THROWS_AS(model.compile(), std::invalid_argument);
+  }
+  SECTION("derivative of wrong unit") {
+    model.add_derivative("v", "v");
+    REQUIRE_THROWS_AS(model.compile(), std::invalid_argument);
+  }
+  SECTION("missing derivative") {
+    REQUIRE_THROWS_AS(model.compile(), std::invalid_argument);
+  }
+  SECTION("unknown quantity") {
+    model.add_derivative("v", "w");
+    REQUIRE_THROWS_AS(model.compile(), std::invalid_argument);
+  }
+  SECTION("unknown unit") {
+    REQUIRE_THROWS_AS(model.add_control("F", "N"), std::invalid_argument);
+  }
+  SECTION("state declared after a control") {
+    model.add_control("a", "m/s^2");
+    REQUIRE_THROWS_AS(model.add_state("y", "m"), std::invalid_argument);
+    REQUIRE(model.stateSize() == 2);
+    REQUIRE(model.controlSize() == 1);
+  }
+  SECTION("derivative of a control") {
+    model.add_control("a", "m/s^2");
+    REQUIRE_THROWS_AS(model.add_derivative("a", "a"), std::invalid_argument);
+  }
+}
+
+TEST_CASE("RuntimeModel rejects interleaved declarations", "[RuntimeSystem]")
+{
+  std::istringstream config("state a m\ncontrol u m/s\nstate b m\ndot a = u\ndot b = u\n");
+  REQUIRE_THROWS_AS(codys::RuntimeModel::parse(config), std::invalid_argument);
+}
+
+TEST_CASE("RuntimeModel shares common subexpressions", "[RuntimeSystem]")
+{
+  codys::RuntimeModel model;
+  model.add_state("x", "1");
+  model.add_state("y", "1");
+  model.add_control("u", "rad");
+  model.add_derivative("x", "2[1/s] * cos(u) / 3");
+  model.add_derivative("y", "cos(u) * 2[1/s] / 3");
+  const auto sys = model.compile();
+
+  // cos, multiply and divide are emitted once for both equations
+  REQUIRE(sys.code().size() == 3);
+}
+
+TEST_CASE("RuntimeModel batch evaluation matches single evaluation", "[RuntimeSystem]")
+{
+  auto sys = runtimeMotion2D().compile();
+  constexpr std::size_t lanes = 4;
+
+  std::array<double, 5 * lanes> batchIn{};
+  for (std::size_t q = 0; q < 5; ++q) {
+    for (std::size_t l = 0; l < lanes; ++l) {
+      batchIn[q * lanes + l] = 0.25 * static_cast<double>(q + 1) * static_cast<double>(l + 1);
+    }
+  }
+  std::array<double, 3 * lanes> batchOut{};
+  sys.evaluate_batch<lanes>(batchIn, batchOut);
+
+  for (std::size_t l = 0; l < lanes; ++l) {
+    std::array<double, 5> in{};
+    for (std::size_t q = 0; q < 5; ++q) {
+      in[q] = batchIn[q * lanes + l];
+    }
+    std::array<double, 3> out{};
+    sys.evaluate(in, out);
+    for (std::size_t q = 0; q < 3; ++q) {
+      REQUIRE(batchOut[q * lanes + l] == out[q]);
+    }
+  }
+}
+
+TEST_CASE("RuntimeModel evaluation rejects spans of the wrong size", "[RuntimeSystem]")
+{
+  auto sys = runtimeMotion2D().compile();
+  std::array<double, 5 * 2> in{};
+  std::array<double, 3 * 2> out{};
+  const auto single = std::span<double>(out).first(3);
+
+  REQUIRE_NOTHROW(sys.evaluate(std::span(in).first(5), single));
+  REQUIRE_THROWS_AS(sys.evaluate(std::span(in).first(4), single), std::invalid_argument);
+  REQUIRE_THROWS_AS(sys.evaluate(std::span(in).first(5), single.first(2)), std::invalid_argument);
+  REQUIRE_NOTHROW(sys.evaluate_batch<2>(in, out));
+  REQUIRE_THROWS_AS(sys.evaluate_batch<2>(std::span(in).first(9), out), std::invalid_argument);
+  REQUIRE_THROWS_AS(sys.evaluate_batch<2>(in, std::span(out).first(5)), std::invalid_argument);
+}
+
+TEST_CASE("SpscRing is first in first out and bounded", "[RealTimeRunner]")
+{
+  codys::SpscRing<int, 4> ring;
+  for (int i = 0; i < 4; ++i) {
+    REQUIRE(ring.try_push(i));
+  }
+  REQUIRE_FALSE(ring.try_push(4));
+
+  int value = -1;
+  REQUIRE(ring.try_pop(value));
+  REQUIRE(value == 0);
+  REQUIRE(ring.try_push(4));
+  for (int i = 1; i < 5; ++i) {
+    REQUIRE(ring.try_pop(value));
+    REQUIRE(value == i);
+  }
+  REQUIRE_FALSE(ring.try_pop(value));
+}
+
+TEST_CASE("RealTimeRunner steps the system at a fixed period", "[RealTimeRunner]")
+{
+  using Sys = codys::StateSpaceSystemOf<Motion2D>;
+  const codys::RealTimeOptions options{.period = std::chrono::microseconds(200)};
+  codys::RealTimeRunner<Sys> runner(options, {1.0, 0.0, 0.0});
+
+  // constant acceleration of 2 * 0.5 along x_0
+  REQUIRE(runner.push_controls({0.5, 0.0}));
+  runner.start();
+
+  std::vector<codys::StateSample<Sys>> samples;
+  const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (samples.size() < 20 && std::chrono::steady_clock::now() < timeout) {
+    codys::StateSample<Sys> sample{};
+    if (runner.pop_state(sample)) {
+      samples.push_back(sample);
+    }
+  }
+  runner.stop();
+
+  REQUIRE(samples.size() == 20);
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    REQUIRE(samples[i].step == i + 1);
+    // v = 1 + t, exact for every integrator
+    REQUIRE(std::abs(samples[i].states[0] - (1.0 + samples[i].time)) < 1e-12);
+  }
+  REQUIRE(runner.step_latency().total() == runner.steps());
+  REQUIRE(runner.release_jitter().total() == runner.steps());
+}
+
+TEST_CASE("Profiler without instrumentation evaluates like the system", "[Instrumentation]")
+{
+  using Sys = codys::StateSpaceSystemOf<Motion2D>;
+  STATIC_REQUIRE(std::is_empty_v<codys::Profiler<Sys, codys::NoInstrumentation>>);
+
+  constexpr std::array statesIn{ 2.0, 0.0, 0.0, 1.5, 0.0 };
+  std::array<double, Sys::stateSize> expected{};
+  std::array<double, Sys::stateSize> out{};
+  Sys::evaluate(statesIn, expected);
+  codys::Profiler<Sys, codys::NoInstrumentation>::evaluate(statesIn, out);
+  REQUIRE(out == expected);
+}
+
+TEST_CASE("Profiler counts evaluations per equation and node type", "[Instrumentation]")
+{
+  using Sys = codys::StateSpaceSystemOf<Motion2D>;
+  codys::Profiler<Sys, codys::SampleCycles<2>> profiler;
+
+  constexpr std::array statesIn{ 2.0, 0.0, 0.0, 1.5, 0.0 };
+  std::array<double, Sys::stateSize> expected{};
+  Sys::evaluate(statesIn, expected);
+  for (int i = 0; i < 10; ++i) {
+    std::array<double, Sys::stateSize> out{};
+    profiler.evaluate(statesIn, out);
+    REQUIRE(out == expected);
+  }
+
+  REQUIRE(profiler.evaluations() == 10);
+  REQUIRE(profiler.samples(0) == 5);
+  REQUIRE(profiler.operand(0) == "v(t)");
+  REQUIRE(profiler.equation_text(0) == "{5} = 2 * {3}");
+
+  const auto nodes = profiler.node_evaluations();
+  REQUIRE(nodes[static_cast<std::size_t>(codys::NodeType::Quantity)] == 50);
+  REQUIRE(nodes[static_cast<std::size_t>(codys::NodeType::Multiply)] == 30);
+  REQUIRE(nodes[static_cast<std::size_t>(codys::NodeType::Sinus)] == 10);
+
+  std::ostringstream json;
+  profiler.write_json(json);
+  REQUIRE(json.str().find(R"json("operand": "v(t)", "equation": "{5} = 2 * {3}", "evaluations": 10, "samples": 5)json") != std::string::npos);
+
+  std::ostringstream trace;
+  profiler.write_chrome_trace(trace);
+  REQUIRE(trace.str().find(R"("ph": "X")") != std::string::npos);
+}
+
+TEST_CASE("Every operation node type has a profiler weight", "[Instrumentation]")
+{
+  constexpr auto weighted = []() {
+    for (std::size_t type = 0; type < codys::node_type_count; ++type) {
+      const auto node = static_cast<codys::NodeType>(type);
+      const bool leaf = node == codys::NodeType::Quantity || node == codys::NodeType::QuantityArray ||
+                        node == codys::NodeType::ScalarValue || node == codys::NodeType::Delayed;
+      if (leaf != (codys::node_type_weight(node) == 0)) {
+        return false;
+      }
+    }
+    return true;
+  }();
+  STATIC_REQUIRE(weighted);
+  STATIC_REQUIRE(codys::node_type_weight(codys::NodeType::FusedMultiplyAdd) == codys::cost_weights::fused_multiply_add);
+}
+
+TEST_CASE("Fused multiply-adds round once at runtime only", "[Schedule]")
+{
+  // (1 + 2^-30) * (1 - 2^-30) - 1 is -2^-60, the rounded product is 1
+  constexpr double lhs = 1.0 + 0x1p-30;
+  constexpr double rhs = 1.0 - 0x1p-30;
+  STATIC_REQUIRE(codys::detail::fused_multiply_add(lhs, rhs, -1.0) == 0.0);
+  const std::array in{ lhs, rhs, -1.0 };
+  REQUIRE(codys::detail::fused_multiply_add(in[0], in[1], in[2]) == -0x1p-60);
+}
+
+TEST_CASE("Dependency graph of combined system is exported", "[DependencyGraph]")
+{
+  using Sys = codys::StateSpaceSystemOf<Motion2DAdvanced>;
+  // quantities: v, x_0, x_1, a (states), Rotation, PropellerForce (controls)
+  STATIC_REQUIRE(codys::dependency_matrix<Sys>[0] == std::array{false, false, false, true, false, false});
+  STATIC_REQUIRE(codys::dependency_matrix<Sys>[3] == std::array{true, false, false, false, false, true});
+  STATIC_REQUIRE(codys::dependency_count<Sys> == 7);
+
+  const auto dot = codys::dependency_graph_dot<Sys>();
+  REQUIRE(dot.find(R"(n0 [label="v [m/s]", shape=ellipse];)") != std::string::npos);
+  REQUIRE(dot.find(R"(n4 [label="q4 [rad]", shape=diamond];)") != std::string::npos);
+  REQUIRE(dot.find(R"(n6 [label="\\dot(v) [m/s²]", shape=box];)") != std::string::npos);
+  REQUIRE(dot.find("n3 -> n6;") != std::string::npos);
+  REQUIRE(dot.find("n5 -> n9;") != std::string::npos);
+
+  const auto json = codys::dependency_graph_json<Sys>();
+  REQUIRE(json.find(R"json({"id": 1, "kind": "state", "symbol": "x_0", "unit": "m", "extent": 1})json") != std::string::npos);
+  REQUIRE(json.find(R"json({"from": 4, "to": 7})json") != std::string::npos);
+}
+
+TEST_CASE("Multi-rate integration of combined system follows single-rate integration", "[MultiRate]")
+{
+  using Sys = codys::StateSpaceSystemOf<Motion2DAdvanced>;
+  // the acceleration is defined by SimplePropeller, all other states by Motion2D
+  STATIC_REQUIRE(codys::detail::rate_groups<Sys, SimplePropeller>::fastEquations == std::array<std::size_t, 1>{3});
+
+  // Velocity, PositionX0, PositionX1, Acceleration; Rotation, PropellerForce
+  constexpr std::array initial{ 1.0, 0.0, 0.0, 0.5 };
+  constexpr std::array controls{ 0.3, 0.2 };
+  const auto integrate = [&]<typename Stepper>(Stepper /*stepper*/, std::size_t steps) {
+    auto states = initial;
+    for (std::size_t i = 0; i < steps; ++i) {
+      Stepper::template step<Sys>(states, controls, 1.0 / static_cast<double>(steps));
+    }
+    return states;
+  };
+
+  const auto reference = integrate(codys::RungeKutta4{}, 10000);
+  const auto sampled = integrate(codys::MultiRate<SimplePropeller, 4>{}, 100);
+  const auto averaged = integrate(codys::MultiRate<SimplePropeller, 4, codys::RungeKutta4, codys::FastCoupling::Average>{}, 100);
+  for (std::size_t i = 0; i < reference.size(); ++i) {
+    // sampling the fast states is first order, averaging them second order
+    REQUIRE(std::abs(sampled[i] - reference[i]) < 1e-2);
+    REQUIRE(std::abs(averaged[i] - reference[i]) < 1e-4);
+  }
+}
+
+using GroundSpeedX = codys::Quantity<class GroundSpeedX_, units::isq::si::speed<units::isq::si::metre_per_second>, "v_x">;
+using Drift = codys::Quantity<class Drift_, units::isq::si::speed<units::isq::si::metre_per_second>, "v_d">;
+using SpeedRate = codys::Quantity<class SpeedRate_, codys::detail::derivative_in_time_t<Velocity::Unit>, "\\dot(v)">;
+
+struct Motion2DOutputs
+{
+  constexpr static auto make_outputs()
+  {
+    return std::make_tuple(
+      codys::output<GroundSpeedX>(Velocity{} * codys::cos(Rotation{})),
+      codys::output<Drift>(Velocity{} * codys::sin(Rotation{}) + codys::DotOf<PositionX0>{}),
+      codys::output<SpeedRate>(codys::DotOf<Velocity>{}));
+  }
+};
+
+TEST_CASE("Outputs are evaluated on request and cached per point", "[Output]")
+{
+  using Sys = codys::StateSpaceSystemOf<Motion2D>;
+  using Outputs = codys::SystemOutputs<Sys, Motion2DOutputs>;
+  // the ground speed is the right-hand side of dot(x_0), the drift contains the one of dot(x_1)
+  STATIC_REQUIRE(std::is_same_v<Outputs::shared_expression_t<GroundSpeedX>, codys::DotOf<PositionX0>>);
+  STATIC_REQUIRE(std::is_same_v<Outputs::shared_expression_t<Drift>,
+                                codys::evaluated_t<decltype(codys::DotOf<PositionX1>{} + codys::DotOf<PositionX0>{})>>);
+  STATIC_REQUIRE(std::is_same_v<Outputs::shared_expression_t<SpeedRate>, codys::DotOf<Velocity>>);
+
+  // Velocity, PositionX0, PositionX1, Acceleration, Rotation
+  constexpr std::array statesIn{ 2.0, 0.0, 0.0, 3.0, 0.5 };
+  Outputs outputs;
+  outputs.update(statesIn);
+  REQUIRE_FALSE(outputs.is_cached<GroundSpeedX>());
+  REQUIRE(outputs.get<GroundSpeedX>() == 2.0 * std::cos(0.5));
+  REQUIRE(outputs.is_cached<GroundSpeedX>());
+  REQUIRE_FALSE(outputs.is_cached<Drift>());
+  REQUIRE(outputs.get<Drift>() == 2.0 * std::sin(0.5) + 2.0 * std::cos(0.5));
+  REQUIRE(outputs.get<SpeedRate>() == 6.0);
+
+  // derivatives of the point handed in by the caller are not recomputed
+  constexpr std::array derivatives{ 1.0, 2.0, 3.0 };
+  outputs.update(statesIn, derivatives);
+  REQUIRE_FALSE(outputs.is_cached<GroundSpeedX>());
+  REQUIRE(outputs.get<GroundSpeedX>() == 2.0);
+  REQUIRE(outputs.get<Drift>() == 3.0 + 2.0);
+  REQUIRE(outputs.get<SpeedRate>() == 1.0);
+}
+
+using Lagging = codys::Quantity<class Lagging_, units::isq::si::length<units::isq::si::metre>, "x">;
+using LaggingOneSecond = codys::Delayed<Lagging, std::ratio<1>>;
+
+struct DelayedDecay
+{
+  constexpr static auto make_dot()
+  {
+    return std::make_tuple(codys::dot<Lagging>(LaggingOneSecond{} * codys::ScalarValue<std::ratio<-1>, per_second_unit>{}));
+  }
+};
+
+TEST_CASE("Delay differential equation follows the method of steps", "[Delay]")
+{
+  using Sys = codys::StateSpaceSystemOf<DelayedDecay>;
+  STATIC_REQUIRE(Sys::controlSize == 1);
+  STATIC_REQUIRE(std::is_same_v<std::tuple_element_t<1, Sys::AllStates>, LaggingOneSecond>);
+
+  // x' = -x(t - 1) with x = 1 before t = 0 is piecewise polynomial:
+  // 1 - t on [0, 1], 1 - t + (t - 1)^2 / 2 on [1, 2], ...
+  std::array states{ 1.0 };
+  constexpr std::array controls{ 0.0 };
+  codys::DelayIntegrator<Sys, 128> integrator(states, 0.0, 0.01);
+  const auto exact = [](double t) {
+    if (t <= 1.0) {
+      return 1.0 - t;
+    }
+    if (t <= 2.0) {
+      return 1.0 - t + (t - 1.0) * (t - 1.0) / 2.0;
+    }
+    return -0.5 + (t - 2.0) * (t - 2.0) / 2.0 - (t - 2.0) * (t - 2.0) * (t - 2.0) / 6.0;
+  };
+  for (int n = 0; n < 300; ++n) {
+    integrator.step(states, controls);
+    REQUIRE(std::abs(states[0] - exact(integrator.time())) < 1e-9);
+  }
+  REQUIRE(std::abs(integrator.time() - 3.0) < 1e-12);
+
+  REQUIRE_THROWS_AS((codys::DelayIntegrator<Sys, 128>(states, 0.0, 2.0)), std::invalid_argument);
+  REQUIRE_THROWS_AS((codys::DelayIntegrator<Sys, 32>(states, 0.0, 0.02)), std::invalid_argument);
+}
+
+using Wealth = codys::Quantity<class Wealth_, units::isq::si::length<units::isq::si::metre>, "w">;
+using GrowthRate = codys::Quantity<class GrowthRate_, per_second_unit, "\\mu">;
+using per_sqrt_second_unit = std::remove_cvref_t<decltype(1 / units::sqrt(1.0 * s))>;
+
+// geometric Brownian motion dw = mu w dt + sigma w dW
+struct GeometricBrownianMotion
+{
+  constexpr static auto make_dot()
+  {
+    return std::make_tuple(codys::dot<Wealth>(Wealth{} * GrowthRate{}));
+  }
+
+  constexpr static auto make_noise()
+  {
+    return std::make_tuple(codys::noise<Wealth>(Wealth{} * codys::ScalarValue<std::ratio<4, 5>, per_sqrt_second_unit>{}));
+  }
+};
+
+TEST_CASE("Stochastic integration is reproducible and Milstein converges strongly", "[Stochastic]")
+{
+  using Sde = codys::StochasticSystem<codys::StateSpaceSystemOf<GeometricBrownianMotion>, GeometricBrownianMotion>;
+  STATIC_REQUIRE(Sde::noiseCount == 1);
+
+  constexpr double dt = 1.0 / 64.0;
+  constexpr std::uint64_t stepCount = 64;
+  constexpr std::array controls{ 0.5 };
+
+  // continuing a trajectory draws the same increments as one long run
+  std::array once{ 1.0 };
+  std::array split{ 1.0 };
+  codys::integrate_sde<Sde>(once, controls, dt, stepCount, 7);
+  codys::integrate_sde<Sde>(split, controls, dt, stepCount / 2, 7);
+  codys::integrate_sde<Sde>(split, controls, dt, stepCount / 2, 7, stepCount / 2);
+  REQUIRE(once == split);
+
+  std::array<double, 3> normals{};
+  codys::standard_normals<3>(7, 0, normals);
+  std::array<double, 1> first{};
+  codys::standard_normals<1>(7, 0, first);
+  REQUIRE(first[0] == normals[0]);
+
+  // strong error at t = 1 against w(1) = exp(mu - sigma^2 / 2 + sigma W(1)) on the same paths
+  double errorEulerMaruyama = 0.0;
+  double errorMilstein = 0.0;
+  constexpr std::uint64_t trajectories = 256;
+  for (std::uint64_t trajectory = 0; trajectory < trajectories; ++trajectory) {
+    double wiener = 0.0;
+    for (std::uint64_t step = 0; step < stepCount; ++step) {
+      std::array<double, 1> z{};
+      codys::standard_normals<1>(trajectory, step, z);
+      wiener += std::sqrt(dt) * z[0];
+    }
+    const double exact = std::exp(0.5 - 0.32 + 0.8 * wiener);
+    std::array eulerMaruyama{ 1.0 };
+    std::array milstein{ 1.0 };
+    codys::integrate_sde<Sde, codys::EulerMaruyama>(eulerMaruyama, controls, dt, stepCount, trajectory);
+    codys::integrate_sde<Sde, codys::Milstein>(milstein, controls, dt, stepCount, trajectory);
+    errorEulerMaruyama += std::abs(eulerMaruyama[0] - exact) / trajectories;
+    errorMilstein += std::abs(milstein[0] - exact) / trajectories;
+  }
+  REQUIRE(errorMilstein < 0.5 * errorEulerMaruyama);
+  REQUIRE(errorMilstein < 0.05);
+}
+
+constexpr double bilinear_drag(double speed, double angle)
+{
+  return 1.0 + 2.0 * speed + 3.0 * angle + speed * angle;
+}
+
+struct DragTable
+{
+  using AxisUnits = std::tuple<Velocity::Unit, Rotation::Unit>;
+  using Unit = Acceleration::Unit;
+  constexpr static auto interpolation = codys::Interpolation::Linear;
+  constexpr static std::string_view symbol = "D";
+  constexpr static std::array speeds{ 0.0, 1.0, 3.0, 4.0 };
+  constexpr static std::array angles{ -1.0, 0.0, 1.0 };
+  constexpr static auto values = []() {
+    std::array<double, speeds.size() * angles.size()> result{};
+    for (std::size_t i = 0; i < speeds.size(); ++i) {
+      for (std::size_t j = 0; j < angles.size(); ++j) {
+        result[i * angles.size() + j] = bilinear_drag(speeds[i], angles[j]);
+      }
+    }
+    return result;
+  }();
+  constexpr static codys::TableGrid<2> grid{ { speeds, angles }, values };
+};
+
+struct SquareTable
+{
+  using AxisUnits = std::tuple<Velocity::Unit>;
+  using Unit = Velocity::Unit;
+  constexpr static auto interpolation = codys::Interpolation::Cubic;
+  constexpr static std::string_view symbol = "S";
+  constexpr static std::array points{ 0.0, 1.0, 2.0, 3.0, 4.0, 5.0 };
+  constexpr static std::array values{ 0.0, 1.0, 4.0, 9.0, 16.0, 25.0 };
+  constexpr static codys::TableGrid<1> grid{ { points }, values };
+};
+
+struct TableDrag
+{
+  constexpr static auto make_dot()
+  {
+    return std::make_tuple(codys::dot<Velocity>(codys::lookup<DragTable>(Velocity{}, Rotation{})));
+  }
+};
+
+TEST_CASE("Lookup tables are interpolated on their grid", "[Table]")
+{
+  STATIC_REQUIRE_FALSE(DragTable::grid.uniform(0));
+  STATIC_REQUIRE(DragTable::grid.uniform(1));
+  STATIC_REQUIRE(DragTable::grid.evaluate<codys::Interpolation::Linear>({ 2.5, 0.25 }) == bilinear_drag(2.5, 0.25));
+  // clamped outside the grid
+  STATIC_REQUIRE(DragTable::grid.evaluate<codys::Interpolation::Linear>({ 9.0, -2.0 }) == bilinear_drag(4.0, -1.0));
+  STATIC_REQUIRE(SquareTable::grid.evaluate<codys::Interpolation::Linear>({ 1e30 }) == 25.0);
+  STATIC_REQUIRE(SquareTable::grid.evaluate<codys::Interpolation::Linear>({ -1e30 }) == 0.0);
+  REQUIRE(std::isnan(SquareTable::grid.evaluate<codys::Interpolation::Linear>({ std::numeric_limits<double>::quiet_NaN() })));
+  // cubic Hermite with central slopes is exact for quadratics away from the boundary
+  REQUIRE(std::abs(SquareTable::grid.evaluate<codys::Interpolation::Cubic>({ 2.5 }) - 6.25) < 1e-12);
+  REQUIRE(std::abs(SquareTable::grid.partial<codys::Interpolation::Cubic>({ 2.5 }, 0) - 5.0) < 1e-12);
+
+  using Sys = codys::StateSpaceSystemOf<TableDrag>;
+  REQUIRE(Sys::format().find("D(v(t), ") != std::string::npos);
+  constexpr std::array statesIn{ 2.5, 0.25 };
+  std::array<double, 1> derivatives{};
+  Sys::evaluate(statesIn, derivatives);
+  REQUIRE(std::abs(derivatives[0] - bilinear_drag(2.5, 0.25)) < 1e-12);
+  std::array<double, 2> jacobian{};
+  codys::jacobian<Sys>(statesIn, jacobian);
+  REQUIRE(std::abs(jacobian[0] - (2.0 + 0.25)) < 1e-12);
+  REQUIRE(std::abs(jacobian[1] - (3.0 + 2.5)) < 1e-12);
+
+  // the binary layout round trips and batches match single lookups
+  const auto bytes = codys::table_bytes(DragTable::grid);
+  const auto loaded = codys::load_table<2>(bytes);
+  const std::array speeds{ 0.0, 0.5, 1.5, 2.5, 3.5, 4.0, -1.0, 5.0, 2.0 };
+  const std::array angles{ -1.0, 0.5, -0.5, 0.25, 1.0, 0.0, 0.0, 2.0, 0.75 };
+  std::array<double, speeds.size()> batch{};
+  loaded.evaluate_batch<codys::Interpolation::Linear>({ speeds, angles }, batch);
+  for (std::size_t lane = 0; lane < speeds.size(); ++lane) {
+    REQUIRE(batch[lane] == DragTable::grid.evaluate<codys::Interpolation::Linear>({ speeds[lane], angles[lane] }));
+  }
+  REQUIRE_THROWS_AS(codys::load_table<3>(bytes), std::invalid_argument);
+  REQUIRE_THROWS_AS(codys::load_table<2>(std::span(bytes).first(bytes.size() - 8)), std::invalid_argument);
+
+  // 2 * (2^60 + 6) doubles wrap around to the 12 the file holds
+  auto crafted = codys::table_bytes(SquareTable::grid);
+  const std::uint64_t wrapping = (std::uint64_t{1} << 60U) + 6;
+  std::memcpy(crafted.data() + codys::table_magic.size() + sizeof(std::uint64_t), &wrapping, sizeof(wrapping));
+  REQUIRE(codys::load_table<1>(codys::table_bytes(SquareTable::grid)).values().size() == 6);
+  REQUIRE_THROWS_AS(codys::load_table<1>(crafted), std::invalid_argument);
+}
+
+TEST_CASE("Control signals are sampled at the stage times", "[Signal]")
+{
+  constexpr std::array times{ 0.0, 1.0, 3.0, 4.0 };
+  constexpr std::array values{ 1.0, 2.0, 0.0, 1.0 };
+  const codys::Signal hold(codys::SignalShape::ZeroOrderHold, times, values);
+  const codys::Signal linear(codys::SignalShape::Linear, times, values);
+  const codys::Signal spline(codys::SignalShape::Spline, times, values);
+  std::size_t cursor = 0;
+  REQUIRE(hold.sample(-1.0, cursor) == 1.0);
+  REQUIRE(hold.sample(2.5, cursor) == 2.0);
+  REQUIRE(hold.sample(5.0, cursor) == 1.0);
+  REQUIRE(linear.sample(2.0, cursor) == 1.0);
+  REQUIRE(linear.sample(0.5, cursor) == 1.5);
+  for (std::size_t i = 0; i < times.size(); ++i) {
+    REQUIRE(std::abs(spline.sample(times[i], cursor) - values[i]) < 1e-12);
+  }
+
+  // a natural spline through points on a line is that line
+  constexpr std::array<codys::SignalSample, 4> log{ { { 0.0, 0.0 }, { 0.5, 1.0 }, { 2.0, 4.0 }, { 2.5, 5.0 } } };
+  const codys::Signal recorded(codys::SignalShape::Spline, log);
+  REQUIRE(std::abs(recorded.sample(1.25, cursor) - 2.5) < 1e-12);
+  REQUIRE_THROWS_AS(codys::Signal(codys::SignalShape::Linear, std::array{ 0.0, 0.0 }, std::array{ 1.0, 2.0 }),
+                    std::invalid_argument);
+
+  const std::vector<double> laneTimes{ 3.5, 0.25, 1.0, 2.0, 3.75, 0.0, 2.5, 1.5, 4.5, 0.75 };
+  std::vector<std::size_t> laneCursors(laneTimes.size(), 0);
+  std::vector<double> batch(laneTimes.size());
+  spline.sample_batch(laneTimes, laneCursors, batch);
+  for (std::size_t lane = 0; lane < laneTimes.size(); ++lane) {
+    REQUIRE(batch[lane] == spline.sample(laneTimes[lane], cursor));
+  }
+
+  // with a = t, dot v = 2 a and dot x_0 = v are polynomials RK4 integrates
+  // exactly, which needs a at the midpoint of every step
+  using Sys = codys::StateSpaceSystem<BasicMotions, BasicControls, Motion2D>;
+  codys::ControlSignals<Sys> signals;
+  signals.bind<Acceleration>(codys::Signal(codys::SignalShape::Linear, std::array{ 0.0, 10.0 }, std::array{ 0.0, 10.0 }));
+  std::array states{ 0.0, 0.0, 0.0 };
+  codys::integrate<Sys>(states, signals, 0.0, 2.0, 0.3);
+  REQUIRE(std::abs(states[2] - 4.0) < 1e-12);
+  REQUIRE(std::abs(states[0] - 8.0 / 3.0) < 1e-12);
+
+  std::vector<double> controls(2 * laneTimes.size());
+  signals.sample_batch(laneTimes, controls);
+  REQUIRE(controls[0] == 3.5);
+  REQUIRE(controls[laneTimes.size()] == 0.0);
+}
+
+using turn_rate_unit = std::remove_cvref_t<decltype(std::declval<Rotation::Unit>() / (1*s))>;
+using square_metre_per_second_unit = std::remove_cvref_t<decltype(std::declval<Lagging::Unit>() * std::declval<Lagging::Unit>() / (1*s))>;
+
+struct Turning
+{
+  constexpr static auto make_dot()
+  {
+    return std::tuple_cat(Motion2D::make_dot(),
+                          std::make_tuple(codys::dot<Rotation>(codys::ScalarValue<std::ratio<1>, turn_rate_unit>{})));
+  }
+};
+
+struct Spreading
+{
+  constexpr static auto make_dot()
+  {
+    return std::make_tuple(codys::dot<Lagging>(codys::ScalarValue<std::ratio<1>, square_metre_per_second_unit>{} / Lagging{}));
+  }
+};
+
+TEST_CASE("Taylor integrator takes large steps at tight tolerances", "[Taylor]")
+{
+  // v = 1 + t / 2 and rotation = t, so the position has a closed form
+  using Sys = codys::StateSpaceSystem<std::tuple<PositionX0, PositionX1, Velocity, Rotation>, std::tuple<Acceleration>, Turning>;
+  codys::TaylorIntegrator<Sys> integrator(1e-14);
+  REQUIRE(integrator.order() == 18);
+  std::array states{ 0.0, 0.0, 1.0, 0.0 };
+  constexpr std::array controls{ 0.25 };
+  constexpr double tEnd = 20.0;
+  const auto steps = integrator.integrate(states, controls, 0.0, tEnd);
+  const double v = 1.0 + tEnd / 2.0;
+  REQUIRE(std::abs(states[0] - (v * std::sin(tEnd) + std::cos(tEnd) / 2.0 - 0.5)) < 1e-10);
+  REQUIRE(std::abs(states[1] - (-v * std::cos(tEnd) + std::sin(tEnd) / 2.0 + 1.0)) < 1e-10);
+  REQUIRE(std::abs(states[2] - v) < 1e-12);
+  REQUIRE(steps < 40);
+
+  // x' = 1 / x has the solution x = sqrt(x0^2 + 2 t)
+  using Spread = codys::StateSpaceSystem<std::tuple<Lagging>, std::tuple<Acceleration>, Spreading>;
+  codys::TaylorIntegrator<Spread, 12> spread(1e-12);
+  REQUIRE(spread.order() == 12);
+  std::array x{ 1.0 };
+  spread.expand(x, std::array{ 0.0 });
+  REQUIRE(spread.coefficient(0, 1) == 1.0);
+  REQUIRE(spread.coefficient(0, 2) == -0.5);
+  REQUIRE(spread.coefficient(0, 3) == 0.5);
+  spread.integrate(x, std::array{ 0.0 }, 0.0, 4.0);
+  REQUIRE(std::abs(x[0] - 3.0) < 1e-10);
+
+  REQUIRE_THROWS_AS(codys::TaylorIntegrator<Spread>(0.0), std::invalid_argument);
+}
+
+using per_second_sq_value = codys::ScalarValue<std::ratio<-1>, per_second_sq_unit>;
+
+// x'' = a - x
+struct Oscillator
+{
+  constexpr static auto make_dot()
+  {
+    return std::make_tuple(codys::dot<PositionX0>(Velocity{}),
+                           codys::dot<Velocity>(Acceleration{} + PositionX0{} * per_second_sq_value{}));
+  }
+};
+
+TEST_CASE("Partitioned integrators split positions and velocities", "[Symplectic]")
+{
+  using Sys = codys::StateSpaceSystem<std::tuple<PositionX0, Velocity>, std::tuple<Acceleration>, Oscillator>;
+  using Split = codys::state_split<Sys>;
+  STATIC_REQUIRE(Split::separable);
+  STATIC_REQUIRE(Split::groupOf == std::array<std::size_t, 2>{ 0, 1 });
+  // dot a reads v and dot v reads a, with the positions on the side of a
+  STATIC_REQUIRE(codys::state_split<codys::StateSpaceSystemOf<Motion2DAdvanced>>::separable);
+  // dot x reads x
+  STATIC_REQUIRE_FALSE(codys::state_split<codys::StateSpaceSystem<std::tuple<Lagging>, std::tuple<Acceleration>, Spreading>>::separable);
+
+  // only the equations of the group are evaluated
+  constexpr std::array statesIn{ 2.0, 3.0, 0.5 };
+  std::array derivatives{ -1.0, -1.0 };
+  codys::evaluate_split_group<Sys, 1>(statesIn, derivatives);
+  REQUIRE(derivatives == std::array{ -1.0, -1.5 });
+
+  // Energy of Stormer-Verlet stays bounded at a step size where RK4 damps
+  // the oscillation away.
+  constexpr std::array controls{ 0.0 };
+  std::array verlet{ 1.0, 0.0 };
+  std::array rk4{ 1.0, 0.0 };
+  for (int n = 0; n < 10000; ++n) {
+    codys::StormerVerlet::step<Sys>(verlet, controls, 0.5);
+    codys::RungeKutta4::step<Sys>(rk4, controls, 0.5);
+  }
+  const auto energy = [](const std::array<double, 2>& states) { return states[0] * states[0] + states[1] * states[1]; };
+  REQUIRE(std::abs(energy(verlet) - 1.0) < 0.1);
+  REQUIRE(energy(rk4) < 0.5);
+
+  // fourth order: halving the step divides the error by about 16
+  const auto error = [&](double dt) {
+    std::array states{ 1.0, 0.0 };
+    const auto steps = static_cast<int>(std::round(10.0 / dt));
+    for (int n = 0; n < steps; ++n) {
+      codys::Yoshida4::step<Sys>(states, controls, dt);
+    }
+    return std::abs(states[0] - std::cos(10.0));
+  };
+  const double ratio = error(0.1) / error(0.05);
+  REQUIRE(ratio > 14.0);
+  REQUIRE(ratio < 18.0);
+}
+
+TEST_CASE("Linear subsystems are propagated exactly", "[Linear]")
+{
+  using Sys = codys::StateSpaceSystemOf<Motion2DAdvanced>;
+  using Split = codys::linear_split<Sys>;
+  // dot v = 2 a and dot a = F - v; the positions read the rotation nonlinearly
+  STATIC_REQUIRE(Split::linearEquations == std::array<std::size_t, 2>{ 0, 3 });
+  STATIC_REQUIRE(Split::stateMatrix == std::array<std::array<double, 2>, 2>{ { { 0.0, 2.0 }, { -1.0, 0.0 } } });
+  STATIC_REQUIRE(Split::inputMatrix == std::array<std::array<double, 2>, 2>{ { { 0.0, 0.0 }, { 0.0, 1.0 } } });
+
+  // Velocity, PositionX0, PositionX1, Acceleration; Rotation, PropellerForce
+  constexpr std::array initial{ 1.0, 0.0, 0.0, 0.5 };
+  constexpr std::array controls{ 0.3, 0.2 };
+  constexpr double dt = 0.5;
+  codys::ExponentialIntegrator<Sys> integrator(dt);
+  auto states = initial;
+  for (int n = 0; n < 20; ++n) {
+    integrator.step(states, controls);
+  }
+  auto reference = initial;
+  for (int n = 0; n < 20000; ++n) {
+    codys::RungeKutta4::step<Sys>(reference, controls, 10.0 / 20000.0);
+  }
+
+  const double omega = std::sqrt(2.0);
+  const double v = 0.2 + 0.8 * std::cos(omega * 10.0) + 1.0 / omega * std::sin(omega * 10.0);
+  REQUIRE(std::abs(states[0] - v) < 1e-12);
+  REQUIRE(std::abs(states[3] - reference[3]) < 1e-12);
+  REQUIRE(std::abs(states[1] - reference[1]) < 1e-4);
+  REQUIRE(std::abs(states[2] - reference[2]) < 1e-4);
+}
+
+TEST_CASE("Parareal converges to the serial fine solution", "[Parareal]")
+{
+  using Sys = codys::StateSpaceSystemOf<Motion2DAdvanced>;
+  // Velocity, PositionX0, PositionX1, Acceleration; Rotation, PropellerForce
+  constexpr std::array initial{ 1.0, 0.0, 0.0, 0.5 };
+  constexpr std::array controls{ 0.3, 0.2 };
+  constexpr codys::PararealOptions options{ .slices = 16, .coarseSteps = 10, .fineSteps = 200, .tolerance = 1e-9 };
+
+  auto serial = initial;
+  for (std::size_t n = 0; n < options.slices * options.fineSteps; ++n) {
+    codys::RungeKutta4::step<Sys>(serial, controls, 20.0 / static_cast<double>(options.slices * options.fineSteps));
+  }
+
+  codys::ThreadPool pool(3);
+  auto states = initial;
+  const auto report = codys::parareal<Sys>(pool, states, controls, 0.0, 20.0, options);
+  REQUIRE(report.iterations < options.slices / 2);
+  REQUIRE(report.correction < options.tolerance);
+  for (std::size_t i = 0; i < states.size(); ++i) {
+    REQUIRE(std::abs(states[i] - serial[i]) < 1e-7);
+  }
+
+  // one iteration per slice reproduces the serial solution
+  auto exhaustive = initial;
+  codys::parareal<Sys>(pool, exhaustive, controls, 0.0, 20.0,
+                       codys::PararealOptions{ .slices = 4, .coarseSteps = 1, .fineSteps = 800, .tolerance = 0.0 });
+  for (std::size_t i = 0; i < states.size(); ++i) {
+    REQUIRE(std::abs(exhaustive[i] - serial[i]) < 1e-12);
+  }
 }
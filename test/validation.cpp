@@ -3,6 +3,8 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include "DenebMotion.hpp"
+
 #include <array>
 
 #include <units/isq/si/acceleration.h>
@@ -11,16 +13,23 @@
 #include <units/generic/angle.h>
 #include <units/generic/dimensionless.h>
 
+#include <codys/CodeGen.hpp>
 #include <codys/Derivative.hpp>
 #include <codys/Operators.hpp>
 #include <codys/Quantity.hpp>
+#include <codys/RuntimeSystem.hpp>
 #include <codys/StateSpaceSystem.hpp>
+#include <codys/SystemInstance.hpp>
 #include <codys/tuple_utilities.hpp>
 
 #include <fmt/format.h>
 
 #include <cmath>
 #include <iostream>
+#include <limits>
+#include <span>
+#include <sstream>
+#include <stdexcept>
 #include <tuple>
 #include <type_traits>
 
@@ -31,33 +40,6 @@ using namespace units;
 namespace codys
 {
 
-using PositionX0 = Quantity<class PositionX0_, length<metre>, "x_0">;
-using PositionX1 = Quantity<class PositionX1_, length<metre>, "x_1">;
-using Velocity = Quantity<class Velocity2_, speed<metre_per_second>, "v">;
-using Yaw = Quantity<class Yaw_, angle<radian, double>, "\\Phi">;
-using Rotation = Quantity<class Rotation_, angular_velocity<radian_per_second>, "\\omega">;
-using PropellerAngle = Quantity<class PropellerAngle_, angle<radian, double>, "\\Psi">;
-using EOT = Quantity<class PropellerForce_, dimensionless<one>, "EOT">;
-
-using p1 = ScalarValue<std::ratio<1, 2>, acceleration<metre_per_second_sq>>;
-using p2 = ScalarValue<std::ratio<1, 3>, angular_acceleration<radian_per_second_sq>>;
-using hundret = ScalarValue<std::ratio<100>, dimensionless<one>>;
-
-struct DenebMotion
-{
-    constexpr static auto make_dot()
-    {
-        constexpr auto dot_pos_x0 = codys::dot<PositionX0>(Velocity{} * codys::cos(Yaw{}));
-        constexpr auto dot_pos_x1 = codys::dot<PositionX1>(Velocity{} * codys::sin(Yaw{}));
-        constexpr auto dot_velocity = codys::dot<Velocity>(p1{} * codys::cos(PropellerAngle{}) * (EOT{} / hundret{}));
-        constexpr auto dot_yaw = codys::dot<Yaw>(Rotation{});
-        constexpr auto dot_rotation = codys::dot<Rotation>(p2{} * codys::sin(PropellerAngle{}) * (EOT{} / hundret{}));
-
-        return std::make_tuple(dot_pos_x0, dot_pos_x1, dot_yaw, dot_velocity, dot_rotation);
-    }
-};
-
-
 TEST_CASE("RealSystem is evaluated correctly", "[RealSystem]")
 {
     using Sys = StateSpaceSystemOf<DenebMotion>;
@@ -72,4 +54,118 @@ TEST_CASE("RealSystem is evaluated correctly", "[RealSystem]")
     std::cout << Sys::format();
 }
 
-}
\ No newline at end of file
+TEST_CASE("RuntimeModel of RealSystem matches the compile-time system", "[RuntimeSystem]")
+{
+    using Sys = StateSpaceSystemOf<DenebMotion>;
+
+    std::istringstream config(R"(
+# Deneb motion, same state order as StateSpaceSystemOf<DenebMotion>
+state x_0 m
+state x_1 m
+state Phi rad
+state v m/s
+state omega rad/s
+control Psi rad
+control EOT 1
+dot x_0 = v * cos(Phi)
+dot x_1 = v * sin(Phi)
+dot Phi = omega
+dot v = 0.5[m/s^2] * cos(Psi) * (EOT / 100)
+dot omega = 0.3333333333333333[rad/s^2] * sin(Psi) * (EOT / 100)
+)");
+    auto runtime = RuntimeModel::parse(config).compile();
+
+    constexpr std::array statesIn{ 1.0, -2.0, 0.3, 4.0, 0.1, 0.2, 50.0 };
+    std::array expected{ 0.0, 0.0, 0.0, 0.0, 0.0 };
+    std::array out{ 0.0, 0.0, 0.0, 0.0, 0.0 };
+    Sys::evaluate(statesIn, expected);
+    runtime.evaluate(statesIn, out);
+
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        REQUIRE(std::abs(out[i] - expected[i]) < 1e-12);
+    }
+}
+
+TEST_CASE("Generated kernel of RealSystem hoists common subexpressions", "[CodeGen]")
+{
+    using Sys = StateSpaceSystemOf<DenebMotion>;
+
+    const auto kernel = generate_kernel<Sys>("deneb");
+    REQUIRE(kernel.find("void deneb(const double* in, double* out)") != std::string::npos);
+    REQUIRE(kernel.find("deneb_jacobian") == std::string::npos);
+
+    // EOT / 100 appears in two equations but is computed once
+    std::size_t divisions = 0;
+    for (auto pos = kernel.find("in[6] / 100.0"); pos != std::string::npos; pos = kernel.find("in[6] / 100.0", pos + 1)) {
+        ++divisions;
+    }
+    REQUIRE(divisions == 1);
+    REQUIRE(kernel.find("out[2] = in[4];") != std::string::npos);
+}
+
+TEST_CASE("Generated literals are valid C", "[CodeGen]")
+{
+    REQUIRE(detail::kernel_literal(2.0) == "2.0");
+    REQUIRE(detail::kernel_literal(1.0 / 3.0) == "0.3333333333333333");
+    REQUIRE(detail::kernel_literal(1e300) == "1e+300");
+    REQUIRE(detail::kernel_literal(std::numeric_limits<double>::infinity()) == "INFINITY");
+    REQUIRE(detail::kernel_literal(-std::numeric_limits<double>::infinity()) == "(-INFINITY)");
+    REQUIRE(detail::kernel_literal(std::numeric_limits<double>::quiet_NaN()) == "NAN");
+}
+
+TEST_CASE("Generated Jacobian of RealSystem contains the non-zero entries", "[CodeGen]")
+{
+    using Sys = StateSpaceSystemOf<DenebMotion>;
+
+    const auto kernel = generate_kernel<Sys>("deneb", {.jacobian = true});
+    REQUIRE(kernel.find("void deneb_jacobian(const double* in, double* jac)") != std::string::npos);
+    // d(dot Phi) / d omega, row 2 and column 4 of a 5 x 7 matrix
+    REQUIRE(kernel.find("jac[18] = 1.0;") != std::string::npos);
+    // d(dot x_0) / d v = cos(Phi)
+    REQUIRE(kernel.find("const double t2 = cos(in[2]);") != std::string::npos);
+    REQUIRE(kernel.find("jac[3] = t2;") != std::string::npos);
+}
+
+TEST_CASE("SystemInterface of RealSystem forwards to the compiled system", "[SystemInterface]")
+{
+    using Sys = StateSpaceSystemOf<DenebMotion>;
+    constexpr static auto system = make_system_interface<Sys>();
+    STATIC_REQUIRE(system.stateSize() == 5);
+    STATIC_REQUIRE(system.inputSize() == 7);
+
+    constexpr std::array statesIn{ 1.0, -2.0, 0.3, 4.0, 0.1, 0.2, 50.0 };
+    std::array expected{ 0.0, 0.0, 0.0, 0.0, 0.0 };
+    std::array out{ 0.0, 0.0, 0.0, 0.0, 0.0 };
+    Sys::evaluate(statesIn, expected);
+    system.evaluate(statesIn, out);
+    REQUIRE(out == expected);
+    REQUIRE(system.format() == Sys::format());
+
+    REQUIRE_THROWS_AS(system.evaluate(std::span(statesIn).first(6), out), std::invalid_argument);
+    REQUIRE_THROWS_AS(system.evaluate(statesIn, std::span(out).first(4)), std::invalid_argument);
+
+    std::array<double, 5 * 7> jac{};
+    REQUIRE_THROWS_AS(system.jacobian(statesIn, std::span(jac).first(34)), std::invalid_argument);
+    REQUIRE_THROWS_AS(system.jacobian(std::span(statesIn).first(5), jac), std::invalid_argument);
+    system.jacobian(statesIn, jac);
+    REQUIRE(jac[18] == 1.0);
+    REQUIRE(jac[3] == std::cos(0.3));
+
+    // central differences agree with the forward-mode derivatives
+    constexpr double h = 1e-6;
+    for (std::size_t input = 0; input < statesIn.size(); ++input) {
+        auto upper = statesIn;
+        auto lower = statesIn;
+        upper[input] += h;
+        lower[input] -= h;
+        std::array upperOut{ 0.0, 0.0, 0.0, 0.0, 0.0 };
+        std::array lowerOut{ 0.0, 0.0, 0.0, 0.0, 0.0 };
+        system.evaluate(upper, upperOut);
+        system.evaluate(lower, lowerOut);
+        for (std::size_t row = 0; row < out.size(); ++row) {
+            REQUIRE(std::abs(jac[row * statesIn.size() + input] - (upperOut[row] - lowerOut[row]) / (2 * h)) < 1e-6);
+        }
+    }
+}
+
+}